@@ -1,6 +1,6 @@
 #include "eeyore/boson.hpp"
 
-int main()
+int main(int argc, char** argv)
 {
   // set the serial port and baud rate	
   int32_t serial_dev = 47;
@@ -9,16 +9,21 @@ int main()
   // instantiate the class
   Boson boson(serial_dev, serial_baud, 640, 512, "/dev/boson_video", "boson");
 
-  //define where the calibration .yaml file is
-  std::string cal_path;
-  cal_path = "/home/jbeason/catkin_ws/src/eeyore/cal/ir_calibration.yaml";
+  // define where the calibration cache and the .yaml file it is built from are
+  std::string cache_path = argc > 1 ? argv[1] : "eeyore_calibration.bin";
+  std::string cal_path = argc > 2 ? argv[2] : "cal/ir_calibration.yaml";
 
-  // get and set the intrinsic and distance coeffs from the calibration file
-  cv::Mat intrinsic = boson.getParams(cal_path, "K");
-  cv::Mat distance = boson.getParams(cal_path, "D");
+  // load the cache, the yaml is only parsed the first time this camera is seen
+  CalibrationStore store(cache_path);
+  std::string serial = boson.getSerialNumber();
 
-  boson.setIntrinsicCoeffs(intrinsic);
-  boson.setDistanceCoeffs(distance);
+  if (store.openCache() < 0 || !store.hasSerial(serial))
+  {
+    store.addFromYaml(serial, cal_path, 640, 512);
+    store.writeCache();
+  }
+
+  boson.loadCalibration(store);
 
   // conduct flat field calibration (FCC) and open up the data link to the sensor
   int result = boson.conductFcc();
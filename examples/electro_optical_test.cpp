@@ -1,6 +1,6 @@
 #include "eeyore/electro_optical.hpp"
 
-int main()
+int main(int argc, char** argv)
 {
   // define the trigger type
   std::string trig =  "HARDWARE_LINE3";
@@ -15,20 +15,26 @@ int main()
   // start the image stream
   blackfly.startCamera();
 
-  // define the path to the .yaml file containing the calibration parameters
-  std::string cal_path = "/home/jbeason/catkin_ws/src/eeyore/cal/eo_calibration.yaml";
-
-  // get and set the intrinsic and distance parameters
-  cv::Mat intrinsic = blackfly.getParams(cal_path, "K");
-  cv::Mat distance = blackfly.getParams(cal_path, "D");
-
-  blackfly.setIntrinsicCoeffs( intrinsic );
-  blackfly.setDistanceCoeffs( distance );
+  // define the calibration cache and the .yaml file it is built from
+  std::string cache_path = argc > 1 ? argv[1] : "eeyore_calibration.bin";
+  std::string cal_path = argc > 2 ? argv[2] : "cal/eo_calibration.yaml";
 
   //optional: get camera serial number and print the device info
   std::string ser_num = blackfly.getSerialNumberFromCam();
   blackfly.printDeviceInfo();
 
+  // load the cache, the yaml is only parsed the first time this camera is seen
+  // pass zero for the size to skip the rectification maps
+  CalibrationStore store(cache_path);
+
+  if (store.openCache() < 0 || !store.hasSerial(ser_num))
+  {
+    store.addFromYaml(ser_num, cal_path, 0, 0);
+    store.writeCache();
+  }
+
+  blackfly.loadCalibration( store );
+
   cv::Mat img;
   cv::Mat resized_img;
   cv::Size2d new_size;
@@ -0,0 +1,136 @@
+#include "eeyore/boson.hpp"
+#include "eeyore/electro_optical.hpp"
+#include "eeyore/realtime.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+
+// burns a core and churns through memory, like the detectors do
+void syntheticLoad( std::atomic<bool>& running )
+{
+  std::vector<uint32_t> scratch(1 << 20);
+  uint32_t x = 1;
+
+  while (running)
+  {
+    for (size_t i = 0; i < scratch.size(); i += 16)
+    {
+      x = x * 1664525 + 1013904223;
+      scratch[i] += x;
+    }
+  }
+}
+
+// grabs frames and reports the spread of the time between deliveries
+void measureJitter( std::string label, std::function<bool()> grab, int frames )
+{
+  std::vector<double> intervals;
+  double last_us = 0.0;
+
+  for (int i = 0; i < frames; i++)
+  {
+    if (!grab())
+    {
+      continue;
+    }
+
+    double now_us = ClockSync::hostNowUs();
+    if (last_us > 0.0)
+    {
+      intervals.push_back(now_us - last_us);
+    }
+    last_us = now_us;
+  }
+
+  if (intervals.size() < 2)
+  {
+    std::cout << label << ": not enough frames" << std::endl;
+    return;
+  }
+
+  double mean = 0.0;
+  for (size_t i = 0; i < intervals.size(); i++)
+  {
+    mean += intervals[i];
+  }
+  mean /= intervals.size();
+
+  double variance = 0.0;
+  for (size_t i = 0; i < intervals.size(); i++)
+  {
+    variance += (intervals[i] - mean) * (intervals[i] - mean);
+  }
+  variance /= intervals.size() - 1;
+
+  std::sort(intervals.begin(), intervals.end());
+  double p99 = intervals[(size_t)(0.99 * (intervals.size() - 1))];
+
+  std::cout << label << ": " << intervals.size() << " intervals, mean " << mean << " us, variance " << variance
+            << " us^2, stddev " << std::sqrt(variance) << " us, p99 " << p99 << " us, max " << intervals.back() << " us" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  // jitter_test <boson|eo> [frames] [load threads] [cpu] [priority]
+  std::string camera = argc > 1 ? argv[1] : "boson";
+  int frames = argc > 2 ? atoi(argv[2]) : 600;
+  int load_threads = argc > 3 ? atoi(argv[3]) : std::thread::hardware_concurrency();
+  int cpu = argc > 4 ? atoi(argv[4]) : 0;
+  int priority = argc > 5 ? atoi(argv[5]) : 80;
+
+  Boson boson(47, 921600, 640, 512, "/dev/boson_video", "boson");
+  ElectroOpticalCam blackfly;
+  std::function<bool()> grab;
+
+  if (camera == "eo")
+  {
+    blackfly.setTrigger(HARDWARE_LINE3);
+    if (blackfly.initCam() < 0 || blackfly.configureTrigger() < 0 || blackfly.setupCamera() < 0 || blackfly.startCamera() < 0)
+    {
+      return 1;
+    }
+    grab = [&blackfly]() { return !blackfly.getFrame().empty(); };
+  }
+  else
+  {
+    if (boson.openSensor() < 0)
+    {
+      return 1;
+    }
+    grab = [&boson]() { return !boson.getFrame().empty(); };
+  }
+
+  // load every core, including the one the capture thread will be pinned to
+  std::atomic<bool> running(true);
+  std::vector<std::thread> load;
+  for (int i = 0; i < load_threads; i++)
+  {
+    load.push_back(std::thread(syntheticLoad, std::ref(running)));
+  }
+
+  measureJitter("default scheduling", grab, frames);
+
+  ThreadConfig config({cpu}, priority);
+  lockMemory();
+  applyThreadConfig(config);
+
+  measureJitter(describeThreadConfig(config) + ", memory locked", grab, frames);
+
+  running = false;
+  for (size_t i = 0; i < load.size(); i++)
+  {
+    load[i].join();
+  }
+
+  if (camera == "eo")
+  {
+    blackfly.closeDevice();
+  }
+  else
+  {
+    boson.closeSensor();
+  }
+
+  return 0;
+}
@@ -0,0 +1,325 @@
+#include "eeyore/boson.hpp"
+#include "eeyore/electro_optical.hpp"
+
+#include <fstream>
+#include <sstream>
+
+// one row of results, all times in milliseconds
+struct ProbeResult
+{
+  std::string camera;
+  int buffers;
+  std::string debayer;
+  bool rectify;
+  std::string clock;
+  int frames;
+  double fps;
+  std::vector<double> latency;
+  std::vector<double> transport;
+  std::vector<double> processing;
+  std::vector<double> interval;
+  uint64_t dropped;
+};
+
+double mean( const std::vector<double>& v )
+{
+  double sum = 0.0;
+  for (size_t i = 0; i < v.size(); i++)
+  {
+    sum += v[i];
+  }
+  return v.empty() ? 0.0 : sum / v.size();
+}
+
+double percentile( std::vector<double> v, double p )
+{
+  if (v.empty())
+  {
+    return 0.0;
+  }
+  std::sort(v.begin(), v.end());
+  return v[(size_t)(p * (v.size() - 1))];
+}
+
+// columns shared by the CSV and JSON output
+std::vector<std::pair<std::string, std::string>> fields( const ProbeResult& r )
+{
+  std::vector<std::pair<std::string, std::string>> f;
+  auto num = [](double v) { std::stringstream ss; ss << v; return ss.str(); };
+
+  f.push_back({"camera", "\"" + r.camera + "\""});
+  f.push_back({"buffers", num(r.buffers)});
+  f.push_back({"debayer", "\"" + r.debayer + "\""});
+  f.push_back({"rectify", r.rectify ? "true" : "false"});
+  f.push_back({"clock", "\"" + r.clock + "\""});
+  f.push_back({"frames", num(r.frames)});
+  f.push_back({"fps", num(r.fps)});
+  f.push_back({"latency_mean_ms", num(mean(r.latency))});
+  f.push_back({"latency_p50_ms", num(percentile(r.latency, 0.5))});
+  f.push_back({"latency_p95_ms", num(percentile(r.latency, 0.95))});
+  f.push_back({"latency_p99_ms", num(percentile(r.latency, 0.99))});
+  f.push_back({"latency_max_ms", num(percentile(r.latency, 1.0))});
+  f.push_back({"transport_mean_ms", num(mean(r.transport))});
+  f.push_back({"transport_p99_ms", num(percentile(r.transport, 0.99))});
+  f.push_back({"processing_mean_ms", num(mean(r.processing))});
+  f.push_back({"processing_p99_ms", num(percentile(r.processing, 0.99))});
+  f.push_back({"interval_mean_ms", num(mean(r.interval))});
+  f.push_back({"interval_p99_ms", num(percentile(r.interval, 0.99))});
+  f.push_back({"dropped", num(r.dropped)});
+  return f;
+}
+
+void writeCsv( std::ostream& out, const std::vector<ProbeResult>& results )
+{
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    std::vector<std::pair<std::string, std::string>> f = fields(results[i]);
+
+    if (i == 0)
+    {
+      for (size_t j = 0; j < f.size(); j++)
+      {
+        out << (j == 0 ? "" : ",") << f[j].first;
+      }
+      out << std::endl;
+    }
+
+    for (size_t j = 0; j < f.size(); j++)
+    {
+      std::string value = f[j].second;
+      value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
+      out << (j == 0 ? "" : ",") << value;
+    }
+    out << std::endl;
+  }
+}
+
+void writeJson( std::ostream& out, const std::vector<ProbeResult>& results )
+{
+  out << "[" << std::endl;
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    std::vector<std::pair<std::string, std::string>> f = fields(results[i]);
+
+    out << "  {";
+    for (size_t j = 0; j < f.size(); j++)
+    {
+      out << (j == 0 ? "" : ", ") << "\"" << f[j].first << "\": " << f[j].second;
+    }
+    out << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+  }
+  out << "]" << std::endl;
+}
+
+// exposure start (camera clock) -> off the stream -> out of getFrame
+ProbeResult probeEo( ElectroOpticalCam& cam, int buffers, DebayerMode debayer, std::string debayer_name, bool rectify, int frames )
+{
+  ProbeResult r;
+  r.camera = "eo";
+  r.buffers = buffers;
+  r.debayer = debayer_name;
+  r.rectify = rectify;
+  r.frames = 0;
+  r.fps = 0.0;
+  r.dropped = 0;
+
+  cam.stopCamera();
+  cam.setStreamBufferCount(buffers);
+  cam.setAcquisitionProfile(PROFILE_MAX_FPS);
+  cam.setDebayerMode(debayer);
+  cam.setRectify(rectify);
+  cam.startCamera();
+
+  // let the stream and the clock fit settle before measuring
+  for (int i = 0; i < 30; i++)
+  {
+    cam.getFrame();
+  }
+  cam.resetFrameStats();
+
+  double latch_device_us = 0.0;
+  double latch_host_us = 0.0;
+  bool latched = cam.latchDeviceClock(latch_device_us, latch_host_us) == 0;
+  r.clock = latched ? "latch" : "fit";
+
+  double first_us = 0.0;
+  double last_us = 0.0;
+  FrameMetadata metadata;
+
+  for (int i = 0; i < frames; i++)
+  {
+    if (cam.getFrame(metadata).empty())
+    {
+      continue;
+    }
+    double app_us = ClockSync::hostNowUs();
+
+    // without the latch the fit soaks up the fixed part of the transport delay
+    double device_us = metadata.timestamp / 1000.0;
+    double exposure_us = latched ? device_us - latch_device_us + latch_host_us : cam.toHostTime(device_us);
+
+    r.latency.push_back((app_us - exposure_us) / 1000.0);
+    r.transport.push_back((metadata.arrival_us - exposure_us) / 1000.0);
+    r.processing.push_back((app_us - metadata.arrival_us) / 1000.0);
+    if (last_us > 0.0)
+    {
+      r.interval.push_back((app_us - last_us) / 1000.0);
+    }
+    else
+    {
+      first_us = app_us;
+    }
+    last_us = app_us;
+    r.frames++;
+  }
+
+  if (r.frames > 1)
+  {
+    r.fps = (r.frames - 1) * 1e6 / (last_us - first_us);
+  }
+  r.dropped = cam.getFrameStats().dropped;
+
+  return r;
+}
+
+// V4L2 buffer timestamp -> dequeued -> out of getFrame, all on CLOCK_MONOTONIC
+ProbeResult probeBoson( Boson& cam, bool rectify, int frames )
+{
+  ProbeResult r;
+  r.camera = "boson";
+  r.buffers = 1;
+  r.debayer = "none";
+  r.rectify = rectify;
+  r.clock = "v4l2";
+  r.frames = 0;
+  r.fps = 0.0;
+  r.dropped = 0;
+
+  cam.setRectify(rectify);
+
+  for (int i = 0; i < 30; i++)
+  {
+    cam.getFrame();
+  }
+  cam.resetFrameStats();
+
+  double first_us = 0.0;
+  double last_us = 0.0;
+
+  for (int i = 0; i < frames; i++)
+  {
+    if (cam.getFrame().empty())
+    {
+      continue;
+    }
+    double app_us = ClockSync::hostNowUs();
+    double buffer_us = cam.getLastBufferTime();
+    double dequeue_us = cam.getLastDequeueTime();
+
+    r.latency.push_back((app_us - buffer_us) / 1000.0);
+    r.transport.push_back((dequeue_us - buffer_us) / 1000.0);
+    r.processing.push_back((app_us - dequeue_us) / 1000.0);
+    if (last_us > 0.0)
+    {
+      r.interval.push_back((app_us - last_us) / 1000.0);
+    }
+    else
+    {
+      first_us = app_us;
+    }
+    last_us = app_us;
+    r.frames++;
+  }
+
+  if (r.frames > 1)
+  {
+    r.fps = (r.frames - 1) * 1e6 / (last_us - first_us);
+  }
+  r.dropped = cam.getFrameStats().dropped;
+
+  return r;
+}
+
+int main(int argc, char** argv)
+{
+  // latency_probe [frames] [both|boson|eo] [trigger] [csv path] [json path] [calibration cache]
+  int frames = argc > 1 ? atoi(argv[1]) : 300;
+  std::string camera = argc > 2 ? argv[2] : "both";
+  std::string trig = argc > 3 ? argv[3] : "SOFTWARE_PIPELINED";
+  std::string csv_path = argc > 4 ? argv[4] : "latency_probe.csv";
+  std::string json_path = argc > 5 ? argv[5] : "latency_probe.json";
+  std::string cache_path = argc > 6 ? argv[6] : "";
+
+  CalibrationStore store(cache_path);
+  bool have_cache = !cache_path.empty() && store.openCache() == 0;
+
+  std::vector<ProbeResult> results;
+
+  if (camera == "both" || camera == "boson")
+  {
+    Boson boson(47, 921600, 640, 512, "/dev/boson_video", "boson");
+
+    if (boson.openSensor() >= 0)
+    {
+      if (have_cache)
+      {
+        boson.loadCalibration(store);
+      }
+
+      results.push_back(probeBoson(boson, false, frames));
+      if (have_cache)
+      {
+        results.push_back(probeBoson(boson, true, frames));
+      }
+      boson.closeSensor();
+    }
+  }
+
+  if (camera == "both" || camera == "eo")
+  {
+    try
+    {
+      ElectroOpticalCam blackfly(0, 0, trig);
+      blackfly.configureTrigger();
+      blackfly.setupCamera();
+
+      if (have_cache)
+      {
+        blackfly.getSerialNumberFromCam();
+        blackfly.loadCalibration(store);
+      }
+
+      const int buffer_counts[] = {3, 16};
+      const DebayerMode modes[] = {DEBAYER_NEAREST_NEIGHBOR, DEBAYER_BILINEAR, DEBAYER_HQ_LINEAR};
+      const char* mode_names[] = {"nearest_neighbor", "bilinear", "hq_linear"};
+
+      for (int b = 0; b < 2; b++)
+      {
+        for (int m = 0; m < 3; m++)
+        {
+          results.push_back(probeEo(blackfly, buffer_counts[b], modes[m], mode_names[m], false, frames));
+          if (have_cache)
+          {
+            results.push_back(probeEo(blackfly, buffer_counts[b], modes[m], mode_names[m], true, frames));
+          }
+        }
+      }
+      blackfly.closeDevice();
+    }
+    catch (std::exception& e)
+    {
+      std::cout << "Skipping the EO camera: " << e.what() << std::endl;
+    }
+  }
+
+  writeCsv(std::cout, results);
+
+  std::ofstream csv(csv_path);
+  writeCsv(csv, results);
+  std::ofstream json(json_path);
+  writeJson(json, results);
+
+  std::cout << "Wrote " << csv_path << " and " << json_path << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,41 @@
+#include "eeyore/payload.hpp"
+
+int main()
+{
+  // instantiate the boson, nothing is opened until the payload starts
+  Boson boson(47, 921600, 640, 512, "/dev/boson_video", "boson");
+
+  // use the default constructor so the spinnaker bring up happens in parallel
+  ElectroOpticalCam blackfly;
+  blackfly.setHeight(0);
+  blackfly.setWidth(0);
+  blackfly.setTrigger(HARDWARE_LINE3);
+
+  // bring up both cameras, the FFC overlaps the V4L2 stream setup
+  Payload payload(boson, blackfly);
+  std::future<int> started = payload.startAsync();
+
+  if (started.get() < 0)
+  {
+    return 1;
+  }
+
+  StartupMetrics metrics = payload.getStartupMetrics();
+  std::cout << "time to first frame: " << metrics.total_ms << " ms" << std::endl;
+
+  cv::Mat ir_img;
+  cv::Mat eo_img;
+
+  while (true)
+  {
+    ir_img = boson.getFrame();
+    eo_img = blackfly.getFrame();
+    cv::imshow("payload_test_ir", ir_img);
+    cv::waitKey(1);
+  }
+
+  boson.closeSensor();
+  blackfly.closeDevice();
+
+  return 0;
+}
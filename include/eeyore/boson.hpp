@@ -20,8 +20,23 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <linux/videodev2.h>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #include "ros/ros.h"
+#include "eeyore/calibration_store.hpp"
+#include "eeyore/frame_stats.hpp"
+#include "eeyore/clock_sync.hpp"
+#include "eeyore/stream_state.hpp"
+#include "eeyore/thermal_palette.hpp"
+#include "eeyore/pixel_pipeline.hpp"
+#include "eeyore/nuc.hpp"
+#include "eeyore/realtime.hpp"
+#include "eeyore/seqlock.hpp"
 
 extern "C"
 {
@@ -34,6 +49,38 @@ extern "C"
 
 using namespace cv;
 
+// Y16 is pre-AGC data, the 8 bit formats carry the camera's own AGC output
+enum BosonFormat
+  {
+    FORMAT_Y16,
+    FORMAT_Y8,
+    FORMAT_YUYV,
+    FORMAT_I420
+  };
+
+// what getFrame hands back, the palette modes are false color and raw is
+// the Y16 counts untouched by AGC, for recording radiometric data
+enum BosonOutput
+  {
+    OUTPUT_GRAY,
+    OUTPUT_PALETTE_BGR,
+    OUTPUT_PALETTE_RGBA,
+    OUTPUT_RAW16
+  };
+
+// sampled by the telemetry thread, sample_time_us is on the ClockSync host clock
+struct BosonTelemetry
+{
+  double fpa_temp_c;
+  bool ffc_in_progress;
+  uint32_t last_ffc_frame;
+  int sync_mode;
+  double sample_time_us;
+  uint64_t samples;
+  uint64_t errors;
+  bool valid;
+};
+
 class Boson
 {
 public:
@@ -51,6 +98,17 @@ public:
   void setSensorName( std::string name );
   void setIntrinsicCoeffs( cv::Mat int_coeffs );
   void setDistanceCoeffs( cv::Mat dist_coeffs );
+  void setRectifyMaps( cv::Mat map1, cv::Mat map2 );
+  void setRectify( bool enable );
+  void setPixelFormat( BosonFormat pixel_format );
+  void setOutputMode( BosonOutput mode );
+  void setPalette( int colormap );
+  void setAutoReconnect( bool enable );
+  void setReconnectTimeout( int timeout_ms );
+  void setNuc( bool enable );
+  void setTelemetryThreadConfig( ThreadConfig config );
+  void setExpectedFramePeriod( double period_us );
+  void setLateFactor( double factor );
   
   // getters
   int32_t getSerialDev();
@@ -61,19 +119,63 @@ public:
   std::string getSensorName();
   cv::Mat getIntrinsicCoeffs();
   cv::Mat getDistanceCoeffs();
+  BosonFormat getPixelFormat();
+  BosonOutput getOutputMode();
+  int getPalette();
+  StreamState getStreamState();
+  ReconnectStats getReconnectStats();
+  FrameStatsSnapshot getFrameStats();
+  double getLastFrameTime();
+  double getLastBufferTime();
+  double getLastDequeueTime();
+  bool getRectify();
+  bool getNuc();
+  NucCorrector& getNucCorrector();
+  BosonTelemetry getTelemetry();
+  ThreadConfig getTelemetryThreadConfig();
   
   // others
   int openSensor();
   int closeSensor();
+  int reconnect();
   cv::Mat getFrame();
-  void grayScale16( Mat input_16, Mat output_16, int height, int width );
+  void grayScale16( Mat input_16, Mat output_16 );
   void AgcBasicLinear( Mat input_16, Mat output_16, int height, int width );
   int conductFcc();
+  int beginFcc();
+  int endFcc();
   int printCamInfo();
   std::string getSerialNumber();
   cv::Mat getParams(std::string file_path, std::string data);
+  int loadCalibration( CalibrationStore& store );
+  void resetFrameStats();
+  double toHostTime( double device_us );
+  int startTelemetry( int period_ms );
+  void stopTelemetry();
   
 private:
+  int readBuffer();
+  void releaseSensor();
+  cv::Mat nextOutputBuffer( int type );
+  void pollTelemetry();
+  template <typename T>
+  bool readUart( FLR_RESULT (*read)( T* ), T* value );
+
+  // holds the UART lock while it lives and opens the SDK session if needed,
+  // the session is closed again on the way out unless telemetry keeps it
+  class UartSession
+  {
+  public:
+    UartSession( Boson& boson );
+    ~UartSession();
+    bool isOpen();
+    void reset();
+
+  private:
+    Boson& boson_;
+    std::unique_lock<std::mutex> lock_;
+  };
+
   // class variables
   int32_t serial_dev_;
   int32_t serial_baud_;
@@ -83,17 +185,57 @@ private:
   std::string video_id_;
   std::string sensor_name_;
   std::string serial_number_;
+  BosonFormat pixel_format_;
+  BosonOutput output_mode_;
+  ThermalPalette palette_;
+  NucCorrector nuc_;
+  bool nuc_enabled_;
     
   int fd_;
+  void* buffer_start_;
+  size_t buffer_length_;
+  StreamState state_;
+  bool auto_reconnect_;
+  int reconnect_timeout_ms_;
+  ReconnectStats reconnect_stats_;
   struct v4l2_format format_;
   struct v4l2_buffer bufferinfo_;
+  FrameStats stats_;
+  ClockSync clock_sync_;
+  double last_device_us_;
+  double last_dequeue_us_;
+
+  // the SDK has one UART session, shared between the telemetry thread and
+  // the one shot commands, and kept open while telemetry runs
+  std::mutex uart_mutex_;
+  bool uart_open_;
+
+  std::thread telemetry_thread_;
+  std::atomic<bool> telemetry_running_;
+  std::mutex telemetry_mutex_;
+  std::condition_variable telemetry_wake_;
+  int telemetry_period_ms_;
+  ThreadConfig telemetry_thread_config_;
+  Seqlock<BosonTelemetry> telemetry_;
+
+  // when the running FFC was started, used to finish the shutter settle
+  std::chrono::steady_clock::time_point fcc_start_;
   
   Mat thermal16_;
   Mat thermal16_linear_;
-  Mat thermal16_out_;
+  Mat thermal8_;
+  // NUC corrected copy of thermal16_
+  Mat thermal16_nuc_;
+  // Y16 AGC result for every raw value up to the frame's max
+  std::vector<uint16_t> agc_lut_;
+
+  // frames handed out by getFrame, reused once the caller drops them
+  std::vector<Mat> output_pool_;
 
   Mat intrinsic_coeffs_;
   Mat distance_coeffs_;
+  Mat rectify_map1_;
+  Mat rectify_map2_;
 };
 #endif
   
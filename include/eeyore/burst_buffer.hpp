@@ -0,0 +1,57 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for a preallocated, memory locked ring of raw frames
+ *        used to capture bursts without any per frame processing
+ */
+
+#ifndef BURST_BUFFER_HPP
+#define BURST_BUFFER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// what was captured into a slot, pixel_format is whatever the camera
+// driver uses to describe the raw data
+struct BurstFrame
+{
+  uint8_t* data;
+  size_t bytes;
+  int width;
+  int height;
+  int pixel_format;
+  int64_t timestamp;
+  int64_t frame_id;
+};
+
+class BurstBuffer
+{
+public:
+  // constructor
+  BurstBuffer();
+  // destructor
+  ~BurstBuffer();
+
+  // getters
+  int getSlotCount();
+  size_t getSlotBytes();
+  int getFrameCount();
+  bool isLocked();
+  BurstFrame& getFrame( int index );
+
+  // others
+  int allocate( int slot_count, size_t slot_bytes );
+  void release();
+  BurstFrame* nextSlot();
+  void clear();
+
+private:
+  uint8_t* memory_;
+  size_t memory_bytes_;
+  size_t slot_bytes_;
+  bool locked_;
+
+  std::vector<BurstFrame> frames_;
+  int frame_count_;
+};
+#endif
@@ -0,0 +1,59 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for the shared calibration store, keeps K/D and
+ *        the rectification maps for each camera serial number in a
+ *        binary cache that is mmap'd at startup
+ */
+
+#ifndef CALIBRATION_STORE_HPP
+#define CALIBRATION_STORE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <map>
+#include <stdint.h>
+
+class CalibrationStore
+{
+public:
+  // constructor
+  CalibrationStore( std::string cache_path );
+  // destructor
+  ~CalibrationStore();
+
+  // getters, the matrices are views into the mapped cache and only good
+  // until it is closed, clone them to keep them
+  std::string getCachePath();
+  bool hasSerial( std::string serial );
+  cv::Mat getIntrinsicCoeffs( std::string serial );
+  cv::Mat getDistanceCoeffs( std::string serial );
+  int getRectifyMaps( std::string serial, cv::Mat& map1, cv::Mat& map2 );
+
+  // others
+  int openCache();
+  void closeCache();
+  int writeCache();
+  int addFromYaml( std::string serial, std::string yaml_path, int width, int height );
+  int addCalibration( std::string serial, cv::Mat int_coeffs, cv::Mat dist_coeffs, int width, int height );
+  static cv::Mat readYaml( std::string file_path, std::string data, std::string tag );
+
+private:
+  struct Entry
+  {
+    int width;
+    int height;
+    cv::Mat intrinsic_coeffs;
+    cv::Mat distance_coeffs;
+    // fixed point maps, CV_16SC2 and CV_16UC1
+    cv::Mat map1;
+    cv::Mat map2;
+  };
+
+  std::string cache_path_;
+  std::map<std::string, Entry> entries_;
+
+  // the mmap'd cache, entries loaded from it point straight into this
+  void* mapped_;
+  size_t mapped_size_;
+};
+#endif
@@ -0,0 +1,62 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for mapping camera timestamps into the host clock,
+ *        fits offset and drift over a sliding window of frame arrivals
+ */
+
+#ifndef CLOCK_SYNC_HPP
+#define CLOCK_SYNC_HPP
+
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+class ClockSync
+{
+public:
+  // constructor
+  ClockSync( int window );
+
+  // setters
+  void setWindow( int window );
+
+  // getters
+  int getWindow();
+  int getSampleCount();
+  double getOffset();
+  double getDrift();
+  bool isValid();
+
+  // others
+  void addSample( double device_us, double host_us );
+  double toHost( double device_us );
+  void reset();
+  static double hostNowUs();
+  static double hostToWallUs( double host_us );
+
+private:
+  void refit();
+
+  std::mutex mutex_;
+
+  int window_;
+  std::vector<double> device_;
+  std::vector<double> host_;
+  int head_;
+  int count_;
+  int since_rebase_;
+
+  // sums are kept relative to the reference sample so they stay well conditioned
+  double ref_device_;
+  double ref_host_;
+  double sum_x_;
+  double sum_y_;
+  double sum_xx_;
+  double sum_xy_;
+
+  // host = ref_host + intercept + slope * (device - ref_device)
+  double slope_;
+  double intercept_;
+  double min_residual_;
+};
+#endif
@@ -12,26 +12,67 @@
 #include <sstream>
 #include <string>
 
+#include "eeyore/calibration_store.hpp"
+#include "eeyore/frame_stats.hpp"
+#include "eeyore/clock_sync.hpp"
+#include "eeyore/burst_buffer.hpp"
+#include "eeyore/stream_state.hpp"
+#include "eeyore/realtime.hpp"
+
 using namespace Spinnaker;
 using namespace Spinnaker::GenApi;
 using namespace Spinnaker::GenICam;
 
+// new values go on the end, consumers may store these as ints
 enum TriggerType
   {
     SOFTWARE,
     HARDWARE_LINE0,
     HARDWARE_LINE1,
     HARDWARE_LINE2,
-    HARDWARE_LINE3
+    HARDWARE_LINE3,
+    SOFTWARE_PIPELINED
   };
 
-  
+// how the camera and the host stream buffers are set up for acquisition
+enum AcquisitionProfile
+  {
+    PROFILE_DEFAULT,
+    PROFILE_MAX_FPS,
+    PROFILE_LOW_LATENCY,
+    PROFILE_NO_DROPS
+  };
+
+// bayer interpolation used when converting to BGR8, fastest first
+enum DebayerMode
+  {
+    DEBAYER_NEAREST_NEIGHBOR,
+    DEBAYER_BILINEAR,
+    DEBAYER_HQ_LINEAR,
+    DEBAYER_EDGE_SENSING,
+    DEBAYER_DIRECTIONAL_FILTER
+  };
+
+// per frame values from the chunk data, timestamp is in device ticks (ns),
+// exposure in us and gain in dB. Without chunk mode valid is false and
+// only the timestamp and frame id are filled in, from the image itself.
+// arrival_us is the host clock (ClockSync::hostNowUs) when the image came off the stream
+struct FrameMetadata
+{
+  int64_t timestamp;
+  int64_t frame_id;
+  double exposure_time;
+  double gain;
+  double arrival_us;
+  bool valid;
+};
+
 class ElectroOpticalCam
 {
 public:
   //constructor
   ElectroOpticalCam( int h, int w, std::string t );
-  ElectroOpticalCam() = default;
+  ElectroOpticalCam();
 
   //setters
   void setHeight( int h );
@@ -39,45 +80,117 @@ public:
   void setTrigger( TriggerType t );
   void setIntrinsicCoeffs( cv::Mat int_coeffs );
   void setDistanceCoeffs( cv::Mat dist_coeffs );
+  void setRectifyMaps( cv::Mat map1, cv::Mat map2 );
+  void setRectify( bool enable );
+  void setDebayerMode( DebayerMode mode );
+  void setTargetFrameRate( double fps );
+  void setStreamBufferCount( int count );
+  void setTriggersInFlight( int count );
+  void setBurstThreadConfig( ThreadConfig config );
+  void setAutoReconnect( bool enable );
+  void setReconnectTimeout( int timeout_ms );
+  void setExpectedFramePeriod( double period_us );
+  void setLateFactor( double factor );
   
   //getters
   int getHeight();
   int getWidth();
   TriggerType getTrigger();
+  int getTriggersInFlight();
+  bool getRectify();
+  DebayerMode getDebayerMode();
+  ThreadConfig getBurstThreadConfig();
+  StreamState getStreamState();
+  ReconnectStats getReconnectStats();
+  AcquisitionProfile getAcquisitionProfile();
+  double getAchievableFrameRate();
   cv::Mat getIntrinsicCoeffs();
   cv::Mat getDistanceCoeffs();
+  FrameStatsSnapshot getFrameStats();
+  FrameMetadata getLastMetadata();
+  double getLastFrameTime();
   
   //functions
   int configureTrigger();
   int resetTrigger();
-  void initCam();
+  int initCam();
+  int reconnect();
+  bool isInitialized();
   int setupCamera();
+  int setAcquisitionProfile( AcquisitionProfile profile );
   int startCamera();
+  int stopCamera();
   cv::Mat getFrame();
+  cv::Mat getFrame( FrameMetadata& metadata );
   int writeFrame(std::string filename);
+  int allocateBurst( int frames );
+  int captureBurst( int frames );
+  int flushBurst( std::string prefix, int threads );
   cv::Mat getParams(std::string file_path, std::string data);
+  int loadCalibration( CalibrationStore& store );
   void closeDevice();
   void quickStart();
   void printDeviceInfo();
   std::string getSerialNumberFromCam();
+  void resetFrameStats();
+  double toHostTime( double device_us );
+  int latchDeviceClock( double& device_us, double& host_us );
 
   
 private:
+  int issueTriggers( bool wait );
+  void drainTriggers();
+  int frameTimeoutMs();
+  void initReconnect();
+  void saveProfileDefaults( INodeMap& stream_map );
+  int restoreProfileDefaults( INodeMap& stream_map );
 
   int height_;
   int width_;
   bool rectify_;
+  bool chunk_mode_;
 
   SystemPtr system_;
   CameraPtr cam_;
   CameraList cam_list_;
   
   ImageProcessor processor_;
+  DebayerMode debayer_mode_;
 
   TriggerType trig_;
+  int triggers_in_flight_;
+  int pending_triggers_;
+  double trigger_spacing_us_;
+  double last_trigger_us_;
+  AcquisitionProfile profile_;
+  double target_frame_rate_;
+  int stream_buffer_count_;
+
+  // node values from before the first profile was applied, PROFILE_DEFAULT
+  // puts them back, a negative value means the node was not readable
+  bool profile_defaults_saved_;
+  int default_frame_rate_enable_;
+  double default_frame_rate_;
+  int64_t default_link_limit_;
+  double default_exposure_upper_;
+  double default_exposure_time_;
+  std::string default_buffer_handling_;
+
+  FrameStats stats_;
+  FrameMetadata last_metadata_;
+  BurstBuffer burst_;
+  ThreadConfig burst_thread_config_;
+
+  StreamState state_;
+  bool auto_reconnect_;
+  int reconnect_timeout_ms_;
+  ReconnectStats reconnect_stats_;
+  ClockSync clock_sync_;
 
   cv::Mat intrinsic_coeffs_;
   cv::Mat distance_coeffs_;
+  cv::Mat rectify_map1_;
+  cv::Mat rectify_map2_;
 
   std::string serial_number_;
 };
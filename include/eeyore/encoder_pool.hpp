@@ -0,0 +1,111 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for the compressed output stage, a pool of JPEG/PNG
+ *        encoders on worker threads that hand back encoded buffers for
+ *        disk or network without allocating per frame
+ */
+
+#ifndef ENCODER_POOL_HPP
+#define ENCODER_POOL_HPP
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include "eeyore/realtime.hpp"
+
+enum EncodeFormat
+  {
+    ENCODE_JPEG,
+    ENCODE_PNG
+  };
+
+// data belongs to the worker and is reused for its next frame, so it is only
+// good for the duration of the callback. Frames finish out of order when
+// there is more than one worker, sequence gives the submit order
+struct EncodedFrame
+{
+  const uint8_t* data;
+  size_t bytes;
+  uint64_t sequence;
+  double timestamp_us;
+  EncodeFormat format;
+  double encode_ms;
+};
+
+struct EncoderWorker;
+
+class EncoderPool
+{
+public:
+  // constructor
+  EncoderPool( int workers, EncodeFormat format );
+  // destructor
+  ~EncoderPool();
+
+  // setters
+  void setJpegQuality( int quality );
+  void setPngCompression( int level );
+  void setQueueDepth( int frames );
+  void setFrameSize( int width, int height, int channels );
+  void setThreadConfig( ThreadConfig config );
+  void setCallback( std::function<void(const EncodedFrame&)> callback );
+
+  // getters
+  EncodeFormat getFormat();
+  int getJpegQuality();
+  int getPngCompression();
+  int getQueueDepth();
+  uint64_t getEncodedCount();
+  uint64_t getDroppedCount();
+
+  // others
+  int start();
+  void stop();
+  int submit( const cv::Mat& frame, double timestamp_us );
+  void flush();
+  static std::function<void(const EncodedFrame&)> fileWriter( std::string prefix );
+
+private:
+  // the frame is shared, not copied, the cameras never write into a frame they handed out
+  struct EncodeJob
+  {
+    cv::Mat frame;
+    uint64_t sequence;
+    double timestamp_us;
+  };
+
+  void workerLoop( EncoderWorker* worker );
+  int encode( EncoderWorker* worker, const EncodeJob& job, EncodedFrame& encoded );
+
+  int worker_count_;
+  EncodeFormat format_;
+  int jpeg_quality_;
+  int png_compression_;
+  int queue_depth_;
+  size_t reserve_bytes_;
+  ThreadConfig thread_config_;
+  std::function<void(const EncodedFrame&)> callback_;
+
+  std::vector<std::unique_ptr<EncoderWorker>> workers_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  std::deque<EncodeJob> queue_;
+  int busy_;
+  bool running_;
+
+  uint64_t next_sequence_;
+  uint64_t encoded_;
+  uint64_t dropped_;
+};
+#endif
@@ -0,0 +1,99 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for the shared memory frame bus, the capture process
+ *        publishes frames into a POSIX shared memory ring that other
+ *        processes map read only
+ */
+
+#ifndef FRAME_BUS_HPP
+#define FRAME_BUS_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <stdint.h>
+#include <sys/types.h>
+
+struct FrameBusHeader;
+
+// per frame flags, a redundant frame is one the frame filter found near
+// identical to the last keyframe
+enum FrameBusFlags
+  {
+    FRAME_FLAG_REDUNDANT = 1
+  };
+
+// image points straight into the shared ring, it is only good until the
+// writer wraps around to its slot, check with FrameBusReader::isValid
+struct FrameBusFrame
+{
+  cv::Mat image;
+  uint64_t sequence;
+  double timestamp_us;
+  uint32_t flags;
+};
+
+class FrameBusWriter
+{
+public:
+  // constructor
+  FrameBusWriter( std::string name, int slot_count, size_t slot_bytes );
+  // destructor
+  ~FrameBusWriter();
+
+  // getters
+  std::string getName();
+  int getSlotCount();
+  size_t getSlotBytes();
+
+  // others
+  int openBus();
+  void closeBus();
+  cv::Mat acquireSlot( int rows, int cols, int type );
+  int commitSlot( double timestamp_us, uint32_t flags = 0 );
+  int publish( const cv::Mat& frame, double timestamp_us, uint32_t flags = 0 );
+
+private:
+  std::string name_;
+  int slot_count_;
+  size_t slot_bytes_;
+
+  FrameBusHeader* header_;
+  size_t mapped_size_;
+
+  // sequence of the slot handed out by acquireSlot, zero when none is open
+  uint64_t pending_sequence_;
+  cv::Mat pending_image_;
+};
+
+class FrameBusReader
+{
+public:
+  // constructor
+  FrameBusReader( std::string name );
+  // destructor
+  ~FrameBusReader();
+
+  // getters
+  std::string getName();
+  uint64_t getSkipped();
+
+  // others
+  int openBus();
+  void closeBus();
+  int waitFrame( FrameBusFrame& frame, int timeout_ms );
+  bool isValid( const FrameBusFrame& frame );
+  bool isStale();
+
+private:
+  std::string name_;
+
+  const FrameBusHeader* header_;
+  size_t mapped_size_;
+  // identifies the segment we mapped, a restarted writer creates a new one
+  dev_t device_;
+  ino_t inode_;
+
+  uint64_t last_sequence_;
+  uint64_t skipped_;
+};
+#endif
@@ -0,0 +1,64 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for redundant frame detection, compares a block mean
+ *        signature of each frame against the last keyframe so near
+ *        identical frames can be dropped or marked before recording
+ */
+
+#ifndef FRAME_FILTER_HPP
+#define FRAME_FILTER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <stdint.h>
+
+// difference is the largest absolute change of any block mean since the
+// last keyframe, as a fraction of full scale
+struct FilterResult
+{
+  bool keyframe;
+  double difference;
+  uint64_t frames_since_keyframe;
+};
+
+class FrameFilter
+{
+public:
+  // constructor
+  FrameFilter();
+
+  // setters
+  void setThreshold( double threshold );
+  void setGrid( int cols, int rows );
+  void setMaxInterval( int frames );
+
+  // getters
+  double getThreshold();
+  int getGridCols();
+  int getGridRows();
+  int getMaxInterval();
+  uint64_t getFrameCount();
+  uint64_t getKeyframeCount();
+  std::vector<float> getSignature();
+
+  // others
+  FilterResult update( const cv::Mat& frame );
+  void computeSignature( const cv::Mat& frame, std::vector<float>& signature );
+  void reset();
+
+private:
+  double threshold_;
+  int grid_cols_;
+  int grid_rows_;
+  int max_interval_;
+
+  uint64_t frames_;
+  uint64_t keyframes_;
+  uint64_t since_keyframe_;
+
+  std::vector<float> signature_;
+  std::vector<float> keyframe_signature_;
+  // per block column byte or word sums for the row being walked
+  std::vector<uint64_t> block_sums_;
+};
+#endif
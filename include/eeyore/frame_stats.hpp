@@ -0,0 +1,67 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for per camera frame accounting, counts delivered,
+ *        dropped, incomplete and late frames and tracks inter-frame jitter
+ */
+
+#ifndef FRAME_STATS_HPP
+#define FRAME_STATS_HPP
+
+#include <mutex>
+#include <string>
+#include <stdint.h>
+
+// intervals are in microseconds of the camera's own clock
+struct FrameStatsSnapshot
+{
+  uint64_t delivered;
+  uint64_t dropped;
+  uint64_t incomplete;
+  uint64_t late;
+  double mean_interval_us;
+  double jitter_us;
+  double max_interval_us;
+};
+
+class FrameStats
+{
+public:
+  // constructor
+  FrameStats();
+
+  // setters
+  void setExpectedPeriod( double period_us );
+  void setLateFactor( double factor );
+
+  // getters
+  double getExpectedPeriod();
+  double getLateFactor();
+  FrameStatsSnapshot getSnapshot();
+
+  // others
+  void update( uint64_t sequence, double timestamp_us, bool incomplete );
+  void reset();
+  void printStats( std::string tag );
+
+private:
+  std::mutex mutex_;
+
+  double expected_period_us_;
+  double late_factor_;
+
+  bool have_last_;
+  uint64_t last_sequence_;
+  double last_timestamp_us_;
+
+  uint64_t delivered_;
+  uint64_t dropped_;
+  uint64_t incomplete_;
+  uint64_t late_;
+
+  // running mean and variance of the per frame interval
+  uint64_t intervals_;
+  double interval_mean_;
+  double interval_m2_;
+  double interval_max_;
+};
+#endif
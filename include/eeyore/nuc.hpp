@@ -0,0 +1,78 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for software non-uniformity correction of raw Y16
+ *        thermal data, per pixel gain/offset with bad pixel replacement
+ *        and scene based offset updates between FFCs
+ */
+
+#ifndef NUC_HPP
+#define NUC_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "eeyore/pixel_pipeline.hpp"
+
+// a bad pixel is replaced by the mean of two good neighbours, all as
+// indices into the (continuous) frame so the fix up is two loads and a store
+struct BadPixelFix
+{
+  uint32_t index;
+  uint32_t source_a;
+  uint32_t source_b;
+};
+
+class NucCorrector
+{
+public:
+  // constructor
+  NucCorrector();
+
+  // setters
+  void setTables( cv::Mat gain, cv::Mat offset );
+  void setBadPixels( const std::vector<cv::Point>& pixels );
+  void setSceneUpdate( bool enable );
+  void setUpdateRate( double rate );
+  void setUpdateInterval( int frames );
+  void setMotionThreshold( double counts );
+
+  // getters
+  cv::Mat getGain();
+  cv::Mat getOffset();
+  std::vector<cv::Point> getBadPixels();
+  bool getSceneUpdate();
+  double getUpdateRate();
+  int getUpdateInterval();
+  double getMotionThreshold();
+
+  // others
+  int loadTables( std::string file_path );
+  int saveTables( std::string file_path );
+  int findBadPixels( const cv::Mat& flat_16, double threshold );
+  int apply( const cv::Mat& input_16, cv::Mat& output_16 );
+  void resetScene();
+
+private:
+  void allocate( int rows, int cols );
+  void buildReplacementMap();
+  void updateScene( const cv::Mat& corrected_16 );
+
+  // corrected = raw * gain + offset, offset_ drifts from base_offset_ with the scene
+  cv::Mat gain_;
+  cv::Mat offset_;
+  cv::Mat base_offset_;
+  bool tables_loaded_;
+
+  std::vector<cv::Point> bad_pixels_;
+  std::vector<BadPixelFix> fixes_;
+
+  bool scene_update_;
+  double update_rate_;
+  int update_interval_;
+  double motion_threshold_;
+  uint64_t frame_count_;
+  cv::Mat previous_;
+};
+#endif
@@ -0,0 +1,82 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for bringing up the EO/IR payload, starts both
+ *        cameras in parallel and records the time to first frame
+ */
+
+#ifndef PAYLOAD_HPP
+#define PAYLOAD_HPP
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+#include "eeyore/boson.hpp"
+#include "eeyore/electro_optical.hpp"
+#include "eeyore/realtime.hpp"
+
+// all times are in milliseconds from the call to start/startAsync,
+// a negative value means that step did not complete
+struct StartupMetrics
+{
+  double eo_init_ms;
+  double eo_first_frame_ms;
+  double ir_stream_ms;
+  double ir_fcc_ms;
+  double ir_first_frame_ms;
+  double total_ms;
+};
+
+class Payload
+{
+public:
+  // constructor
+  Payload( Boson& boson, ElectroOpticalCam& eo );
+  // destructor
+  ~Payload();
+
+  // setters
+  void setFirstFrameTimeout( int timeout_ms );
+  void setIrThreadConfig( ThreadConfig config );
+  void setEoThreadConfig( ThreadConfig config );
+  void setLockMemory( bool enable );
+
+  // getters
+  int getFirstFrameTimeout();
+  StartupMetrics getStartupMetrics();
+  ThreadConfig getIrThreadConfig();
+  ThreadConfig getEoThreadConfig();
+  bool getLockMemory();
+
+  // others
+  int start();
+  std::future<int> startAsync();
+  int startCapture( std::function<void(const cv::Mat&)> ir_callback, std::function<void(const cv::Mat&)> eo_callback );
+  void stopCapture();
+  void printStartupMetrics();
+
+private:
+  int startIr();
+  int startEo();
+  void captureLoop( ThreadConfig config, std::function<cv::Mat()> grab, std::function<void(const cv::Mat&)> callback );
+  double elapsedMs();
+
+  Boson& boson_;
+  ElectroOpticalCam& eo_;
+
+  int first_frame_timeout_ms_;
+  ThreadConfig ir_thread_config_;
+  ThreadConfig eo_thread_config_;
+  bool lock_memory_;
+
+  std::chrono::steady_clock::time_point start_time_;
+  StartupMetrics metrics_;
+
+  // one long lived capture thread per camera, running under that camera's config
+  std::thread ir_thread_;
+  std::thread eo_thread_;
+  std::atomic<bool> capturing_;
+};
+#endif
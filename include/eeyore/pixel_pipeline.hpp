@@ -0,0 +1,375 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header only framework for fusing per pixel stages into one loop.
+ *        Stages are chained at compile time so the whole chain runs in a
+ *        single pass over the image, with SIMD kernels for the common IR
+ *        chains (AGC, and offset/gain correction followed by AGC)
+ */
+
+#ifndef PIXEL_PIPELINE_HPP
+#define PIXEL_PIPELINE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define EEYORE_PIPELINE_SIMD 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define EEYORE_PIPELINE_SIMD 1
+#endif
+
+/* A stage has an input_type and output_type, a beginRow hook for stages
+ * with per pixel tables, and maps one pixel at a time:
+ *
+ *   struct MyStage
+ *   {
+ *     typedef uint16_t input_type;
+ *     typedef uint8_t output_type;
+ *     void beginRow( int row );
+ *     output_type operator()( input_type v, int col ) const;
+ *   };
+ */
+
+// per pixel gain and offset, e.g. a NUC table: out = v * gain + offset
+struct OffsetGainStage
+{
+  typedef uint16_t input_type;
+  typedef uint16_t output_type;
+
+  OffsetGainStage( const cv::Mat& gain, const cv::Mat& offset ) : gain_(gain), offset_(offset), gain_row_(0), offset_row_(0) {}
+
+  void beginRow( int row )
+  {
+    gain_row_ = gain_.ptr<float>(row);
+    offset_row_ = offset_.ptr<float>(row);
+  }
+
+  output_type operator()( input_type v, int col ) const
+  {
+    float r = v * gain_row_[col] + offset_row_[col];
+    return r <= 0.0f ? 0 : (r >= 65535.0f ? 65535 : (output_type)r);
+  }
+
+  cv::Mat gain_;
+  cv::Mat offset_;
+  const float* gain_row_;
+  const float* offset_row_;
+};
+
+// linear AGC, stretches [min, max] over the full range of the output type
+template <typename Out>
+struct AgcStage
+{
+  typedef uint16_t input_type;
+  typedef Out output_type;
+
+  AgcStage( double min, double max ) : min_((float)min), scale_(max > min ? (float)(OUT_MAX / (max - min)) : 0.0f) {}
+
+  void beginRow( int row ) {}
+
+  output_type operator()( input_type v, int col ) const
+  {
+    float r = (v - min_) * scale_;
+    return r <= 0.0f ? 0 : (r >= OUT_MAX ? (output_type)OUT_MAX : (output_type)r);
+  }
+
+  static constexpr float OUT_MAX = sizeof(Out) == 1 ? 255.0f : 65535.0f;
+
+  float min_;
+  float scale_;
+};
+
+template <typename Out>
+constexpr float AgcStage<Out>::OUT_MAX;
+
+// table lookup, inputs past the end of the table take its last entry
+template <typename In, typename Out>
+struct LutStage
+{
+  typedef In input_type;
+  typedef Out output_type;
+
+  LutStage( const Out* table, int size ) : table_(table), last_(size - 1) {}
+
+  void beginRow( int row ) {}
+
+  output_type operator()( input_type v, int col ) const
+  {
+    return table_[(int)v > last_ ? last_ : v];
+  }
+
+  const Out* table_;
+  int last_;
+};
+
+// 16 to 8 bit by dropping the low byte
+struct NarrowStage
+{
+  typedef uint16_t input_type;
+  typedef uint8_t output_type;
+
+  void beginRow( int row ) {}
+
+  output_type operator()( input_type v, int col ) const
+  {
+    return v >> 8;
+  }
+};
+
+// compile time chain of stages, each feeding the next
+template <typename First, typename... Rest>
+struct StageChain
+{
+  typedef typename First::input_type input_type;
+  typedef typename StageChain<Rest...>::output_type output_type;
+
+  StageChain( const First& first, const Rest&... rest ) : first(first), rest(rest...) {}
+
+  void beginRow( int row )
+  {
+    first.beginRow(row);
+    rest.beginRow(row);
+  }
+
+  output_type operator()( input_type v, int col ) const
+  {
+    return rest(first(v, col), col);
+  }
+
+  First first;
+  StageChain<Rest...> rest;
+};
+
+template <typename Last>
+struct StageChain<Last>
+{
+  typedef typename Last::input_type input_type;
+  typedef typename Last::output_type output_type;
+
+  StageChain( const Last& first ) : first(first) {}
+
+  void beginRow( int row )
+  {
+    first.beginRow(row);
+  }
+
+  output_type operator()( input_type v, int col ) const
+  {
+    return first(v, col);
+  }
+
+  Last first;
+};
+
+#ifdef EEYORE_PIPELINE_SIMD
+// the handful of vector ops the kernels need, 8 pixels at a time as two halves
+namespace pipeline_simd
+{
+#if defined(__SSE2__)
+  typedef __m128 f32x4;
+
+  inline f32x4 set( float v ) { return _mm_set1_ps(v); }
+  inline f32x4 sub( f32x4 a, f32x4 b ) { return _mm_sub_ps(a, b); }
+  inline f32x4 add( f32x4 a, f32x4 b ) { return _mm_add_ps(a, b); }
+  inline f32x4 mul( f32x4 a, f32x4 b ) { return _mm_mul_ps(a, b); }
+  inline f32x4 clamp( f32x4 a, f32x4 hi ) { return _mm_min_ps(_mm_max_ps(a, _mm_setzero_ps()), hi); }
+  inline f32x4 trunc( f32x4 a ) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); }
+  inline f32x4 load( const float* p ) { return _mm_loadu_ps(p); }
+
+  inline void load( const uint16_t* p, f32x4& lo, f32x4& hi )
+  {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+    hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, _mm_setzero_si128()));
+  }
+
+  // inputs are already clamped to the output range
+  inline void store( uint16_t* p, f32x4 lo, f32x4 hi )
+  {
+    // SSE2 has no unsigned 32 to 16 bit pack, shift into signed range and back
+    __m128i bias = _mm_set1_epi32(32768);
+    __m128i a = _mm_sub_epi32(_mm_cvttps_epi32(lo), bias);
+    __m128i b = _mm_sub_epi32(_mm_cvttps_epi32(hi), bias);
+    __m128i r = _mm_add_epi16(_mm_packs_epi32(a, b), _mm_set1_epi16((short)0x8000));
+    _mm_storeu_si128((__m128i*)p, r);
+  }
+
+  inline void store( uint8_t* p, f32x4 lo, f32x4 hi )
+  {
+    __m128i r = _mm_packs_epi32(_mm_cvttps_epi32(lo), _mm_cvttps_epi32(hi));
+    _mm_storel_epi64((__m128i*)p, _mm_packus_epi16(r, r));
+  }
+#elif defined(__ARM_NEON)
+  typedef float32x4_t f32x4;
+
+  inline f32x4 set( float v ) { return vdupq_n_f32(v); }
+  inline f32x4 sub( f32x4 a, f32x4 b ) { return vsubq_f32(a, b); }
+  inline f32x4 add( f32x4 a, f32x4 b ) { return vaddq_f32(a, b); }
+  inline f32x4 mul( f32x4 a, f32x4 b ) { return vmulq_f32(a, b); }
+  inline f32x4 clamp( f32x4 a, f32x4 hi ) { return vminq_f32(vmaxq_f32(a, vdupq_n_f32(0.0f)), hi); }
+  inline f32x4 trunc( f32x4 a ) { return vcvtq_f32_s32(vcvtq_s32_f32(a)); }
+  inline f32x4 load( const float* p ) { return vld1q_f32(p); }
+
+  inline void load( const uint16_t* p, f32x4& lo, f32x4& hi )
+  {
+    uint16x8_t v = vld1q_u16(p);
+    lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(v)));
+    hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(v)));
+  }
+
+  inline void store( uint16_t* p, f32x4 lo, f32x4 hi )
+  {
+    vst1q_u16(p, vcombine_u16(vmovn_u32(vcvtq_u32_f32(lo)), vmovn_u32(vcvtq_u32_f32(hi))));
+  }
+
+  inline void store( uint8_t* p, f32x4 lo, f32x4 hi )
+  {
+    uint16x8_t r = vcombine_u16(vmovn_u32(vcvtq_u32_f32(lo)), vmovn_u32(vcvtq_u32_f32(hi)));
+    vst1_u8(p, vmovn_u16(r));
+  }
+#endif
+}
+#endif
+
+// runs a chain over one row, the generic version is the scalar loop and the
+// specializations below cover the chains worth vectorizing
+template <typename Chain>
+struct RowKernel
+{
+  static void run( const Chain& chain, const typename Chain::input_type* in, typename Chain::output_type* out, int cols )
+  {
+    for (int j = 0; j < cols; j++)
+      {
+	out[j] = chain(in[j], j);
+      }
+  }
+};
+
+template <typename Out>
+struct RowKernel< StageChain< AgcStage<Out> > >
+{
+  typedef StageChain< AgcStage<Out> > Chain;
+
+  static void run( const Chain& chain, const uint16_t* in, Out* out, int cols )
+  {
+    int j = 0;
+#ifdef EEYORE_PIPELINE_SIMD
+    using namespace pipeline_simd;
+    const AgcStage<Out>& agc = chain.first;
+    f32x4 min = set(agc.min_);
+    f32x4 scale = set(agc.scale_);
+    f32x4 top = set(AgcStage<Out>::OUT_MAX);
+
+    for (; j + 8 <= cols; j += 8)
+      {
+	f32x4 lo, hi;
+	load(in + j, lo, hi);
+	store(out + j, clamp(mul(sub(lo, min), scale), top), clamp(mul(sub(hi, min), scale), top));
+      }
+#endif
+    for (; j < cols; j++)
+      {
+	out[j] = chain(in[j], j);
+      }
+  }
+};
+
+template <>
+struct RowKernel< StageChain< OffsetGainStage > >
+{
+  typedef StageChain< OffsetGainStage > Chain;
+
+  static void run( const Chain& chain, const uint16_t* in, uint16_t* out, int cols )
+  {
+    int j = 0;
+#ifdef EEYORE_PIPELINE_SIMD
+    using namespace pipeline_simd;
+    const OffsetGainStage& nuc = chain.first;
+    f32x4 top16 = set(65535.0f);
+
+    for (; j + 8 <= cols; j += 8)
+      {
+	f32x4 lo, hi;
+	load(in + j, lo, hi);
+	store(out + j, clamp(add(mul(lo, load(nuc.gain_row_ + j)), load(nuc.offset_row_ + j)), top16),
+	      clamp(add(mul(hi, load(nuc.gain_row_ + j + 4)), load(nuc.offset_row_ + j + 4)), top16));
+      }
+#endif
+    for (; j < cols; j++)
+      {
+	out[j] = chain(in[j], j);
+      }
+  }
+};
+
+template <typename Out>
+struct RowKernel< StageChain< OffsetGainStage, AgcStage<Out> > >
+{
+  typedef StageChain< OffsetGainStage, AgcStage<Out> > Chain;
+
+  static void run( const Chain& chain, const uint16_t* in, Out* out, int cols )
+  {
+    int j = 0;
+#ifdef EEYORE_PIPELINE_SIMD
+    using namespace pipeline_simd;
+    const OffsetGainStage& nuc = chain.first;
+    const AgcStage<Out>& agc = chain.rest.first;
+    f32x4 top16 = set(65535.0f);
+    f32x4 min = set(agc.min_);
+    f32x4 scale = set(agc.scale_);
+    f32x4 top = set(AgcStage<Out>::OUT_MAX);
+
+    for (; j + 8 <= cols; j += 8)
+      {
+	f32x4 lo, hi;
+	load(in + j, lo, hi);
+
+	// round to 16 bit between the stages, same as the scalar chain
+	lo = trunc(clamp(add(mul(lo, load(nuc.gain_row_ + j)), load(nuc.offset_row_ + j)), top16));
+	hi = trunc(clamp(add(mul(hi, load(nuc.gain_row_ + j + 4)), load(nuc.offset_row_ + j + 4)), top16));
+
+	store(out + j, clamp(mul(sub(lo, min), scale), top), clamp(mul(sub(hi, min), scale), top));
+      }
+#endif
+    for (; j < cols; j++)
+      {
+	out[j] = chain(in[j], j);
+      }
+  }
+};
+
+template <typename... Stages>
+class PixelPipeline
+{
+public:
+  typedef StageChain<Stages...> Chain;
+  typedef typename Chain::input_type input_type;
+  typedef typename Chain::output_type output_type;
+
+  PixelPipeline( const Stages&... stages ) : chain_(stages...) {}
+
+  // output is (re)allocated only when its size or type is wrong, so an
+  // existing buffer gets written in place
+  void run( const cv::Mat& input, cv::Mat& output )
+  {
+    CV_Assert(input.type() == cv::DataType<input_type>::type);
+    output.create(input.rows, input.cols, cv::DataType<output_type>::type);
+
+    for (int i = 0; i < input.rows; i++)
+      {
+	chain_.beginRow(i);
+	RowKernel<Chain>::run(chain_, input.ptr<input_type>(i), output.ptr<output_type>(i), input.cols);
+      }
+  }
+
+  Chain& getChain()
+  {
+    return chain_;
+  }
+
+private:
+  Chain chain_;
+};
+#endif
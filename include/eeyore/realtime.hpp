@@ -0,0 +1,31 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for real time scheduling of capture and processing
+ *        threads, CPU affinity, SCHED_FIFO priority and memory locking
+ */
+
+#ifndef REALTIME_HPP
+#define REALTIME_HPP
+
+#include <string>
+#include <vector>
+
+// no cpus means the thread can run anywhere, priority 0 leaves it on
+// SCHED_OTHER (at the given nice value) and 1-99 moves it to SCHED_FIFO
+struct ThreadConfig
+{
+  ThreadConfig() : priority(0), nice(0) {}
+  ThreadConfig( std::vector<int> cpus, int priority, int nice = 0 ) : cpus(cpus), priority(priority), nice(nice) {}
+
+  std::vector<int> cpus;
+  int priority;
+  int nice;
+};
+
+// applies to the calling thread, SCHED_FIFO needs CAP_SYS_NICE or an rtprio limit
+int applyThreadConfig( const ThreadConfig& config );
+// keeps every page of the process resident, current and future
+int lockMemory();
+void unlockMemory();
+std::string describeThreadConfig( const ThreadConfig& config );
+#endif
@@ -0,0 +1,91 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for EO/IR registration, precomputes a fixed point map
+ *        from the (downscaled) EO frame into the Boson image and blends
+ *        false color thermal over the EO frame in one pass per frame pair
+ */
+
+#ifndef REGISTRATION_HPP
+#define REGISTRATION_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "eeyore/calibration_store.hpp"
+#include "eeyore/thermal_palette.hpp"
+
+class EoIrRegistration
+{
+public:
+  // constructor
+  EoIrRegistration();
+
+  // setters
+  void setEoSize( int width, int height );
+  void setIrSize( int width, int height );
+  void setOutputSize( int width, int height );
+  void setExtrinsics( cv::Mat rotation, cv::Mat translation );
+  void setSceneDistance( double meters );
+  void setEoRectified( bool rectified );
+  void setIrRectified( bool rectified );
+  void setAlpha( double alpha );
+  void setPalette( int colormap );
+
+  // getters
+  int getOutputWidth();
+  int getOutputHeight();
+  double getSceneDistance();
+  double getAlpha();
+  cv::Mat getMap1();
+  cv::Mat getMap2();
+
+  // others
+  int loadCalibration( std::string eo_yaml, std::string ir_yaml, std::string extrinsics_yaml );
+  int buildMaps();
+  int overlay( const cv::Mat& eo_bgr, const cv::Mat& ir, cv::Mat& output );
+
+private:
+  void blendRow( const uint8_t* eo, const uint8_t* thermal, uint8_t* out, int bytes );
+
+  // sizes the calibrations were done at, and the overlay geometry
+  int eo_width_;
+  int eo_height_;
+  int ir_width_;
+  int ir_height_;
+  int out_width_;
+  int out_height_;
+
+  cv::Mat eo_intrinsic_coeffs_;
+  cv::Mat eo_distance_coeffs_;
+  cv::Mat ir_intrinsic_coeffs_;
+  cv::Mat ir_distance_coeffs_;
+
+  // takes points in the EO camera frame to the IR camera frame, meters
+  cv::Mat rotation_;
+  cv::Mat translation_;
+  // the scene is taken as a plane this far in front of the EO camera
+  double scene_distance_;
+
+  // whether the frames handed to overlay are already undistorted
+  bool eo_rectified_;
+  bool ir_rectified_;
+
+  // output pixel to IR pixel, CV_16SC2 and CV_16UC1 like cv::convertMaps makes
+  cv::Mat map1_;
+  cv::Mat map2_;
+  bool maps_valid_;
+
+  int alpha_;
+  ThermalPalette palette_;
+
+  // output column to EO byte offset, for whatever EO width came in last
+  std::vector<int> eo_offsets_;
+  int eo_offsets_cols_;
+
+  cv::Mat ir8_;
+  std::vector<uint8_t> eo_row_;
+  std::vector<uint8_t> thermal_row_;
+};
+#endif
@@ -0,0 +1,53 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Single writer seqlock for publishing small snapshot structs,
+ *        readers never block the writer and never take a lock
+ */
+
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <atomic>
+#include <stdint.h>
+
+// T has to be trivially copyable, a reader that races the writer retries
+template <typename T>
+class Seqlock
+{
+public:
+  Seqlock() : sequence_(0), value_() {}
+
+  // only ever called from one thread
+  void store( const T& value )
+  {
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    value_ = value;
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T load() const
+  {
+    T value;
+    uint32_t before, after;
+
+    do
+      {
+	before = sequence_.load(std::memory_order_acquire);
+	value = value_;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	after = sequence_.load(std::memory_order_relaxed);
+      }
+    while (before != after || (before & 1));
+
+    return value;
+  }
+
+private:
+  std::atomic<uint32_t> sequence_;
+  T value_;
+};
+#endif
@@ -0,0 +1,27 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Stream state and reconnect accounting shared by the camera classes
+ */
+
+#ifndef STREAM_STATE_HPP
+#define STREAM_STATE_HPP
+
+#include <stdint.h>
+
+enum StreamState
+  {
+    STREAM_CLOSED,
+    STREAM_STREAMING,
+    STREAM_RECONNECTING,
+    STREAM_FAILED
+  };
+
+// latencies are in milliseconds from the failed read to the stream being back up
+struct ReconnectStats
+{
+  uint64_t reconnects;
+  uint64_t failures;
+  double last_latency_ms;
+  double max_latency_ms;
+};
+#endif
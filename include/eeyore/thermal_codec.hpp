@@ -0,0 +1,82 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for the lossless Y16 codec, predicts each pixel from
+ *        its neighbours or the previous frame and bit packs the residuals
+ *        in blocks of 128 pixels for recording and downlink of radiometric data
+ */
+
+#ifndef THERMAL_CODEC_HPP
+#define THERMAL_CODEC_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <stdint.h>
+
+// stream layout, all little endian:
+//   header   "EYTC", version, frame type (0 intra, 1 inter), then u16 width, height
+//            and frame counter, which goes up by one every frame and wraps
+//   blocks   per row, one per 128 pixels: a byte of predictor << 5 | bit width,
+//            then 16 * width bytes of zigzagged residuals packed across 8 lanes
+enum ThermalPredictor
+  {
+    PREDICT_LEFT,
+    PREDICT_UP,
+    PREDICT_TEMPORAL,
+    PREDICT_TEMPORAL_LEFT
+  };
+
+class ThermalEncoder
+{
+public:
+  // constructor
+  ThermalEncoder();
+
+  // setters
+  void setKeyframeInterval( int frames );
+
+  // getters
+  int getKeyframeInterval();
+
+  // others
+  int encode( const cv::Mat& frame_16, uint8_t* out, size_t capacity );
+  int encode( const cv::Mat& frame_16, std::vector<uint8_t>& out );
+  void reset();
+  static size_t maxEncodedSize( int width, int height );
+
+private:
+  // last frame seen, in the same padded row layout the decoder rebuilds
+  std::vector<uint16_t> previous_;
+  int width_;
+  int height_;
+  int keyframe_interval_;
+  int since_keyframe_;
+  uint16_t frame_counter_;
+
+  std::vector<uint16_t> current_row_;
+  // what the first row predicts from
+  std::vector<uint16_t> zero_row_;
+  std::vector<uint16_t> residuals_;
+};
+
+class ThermalDecoder
+{
+public:
+  // constructor
+  ThermalDecoder();
+
+  // others
+  int decode( const uint8_t* data, size_t bytes, cv::Mat& frame_16 );
+  void reset();
+
+private:
+  std::vector<uint16_t> previous_;
+  int width_;
+  int height_;
+  uint16_t last_counter_;
+
+  std::vector<uint16_t> current_row_;
+  // what the first row predicts from
+  std::vector<uint16_t> zero_row_;
+  std::vector<uint16_t> residuals_;
+};
+#endif
@@ -0,0 +1,48 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Header file for false color thermal output, maps raw Y16 data to
+ *        BGR8 or RGBA through a combined AGC and palette lookup table
+ */
+
+#ifndef THERMAL_PALETTE_HPP
+#define THERMAL_PALETTE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <stdint.h>
+
+class ThermalPalette
+{
+public:
+  // constructor
+  ThermalPalette();
+
+  // setters
+  void setPalette( int colormap );
+
+  // getters
+  int getPalette();
+  int getRangeMin();
+  int getRangeMax();
+  const std::vector<uint32_t>& getColors( bool rgba );
+
+  // others
+  void apply16( const cv::Mat& input_16, cv::Mat& output, bool rgba );
+  void apply8( const cv::Mat& input_8, cv::Mat& output, bool rgba );
+
+private:
+  void rebuildLut( int min, int max, bool rgba );
+
+  int colormap_;
+  // the palette's 256 colors, packed as the bytes of the output pixel
+  std::vector<uint32_t> colors_bgra_;
+  std::vector<uint32_t> colors_rgba_;
+
+  // raw value to output pixel for the current AGC range
+  std::vector<uint32_t> lut_;
+  int lut_min_;
+  int lut_max_;
+  bool lut_rgba_;
+  bool lut_valid_;
+};
+#endif
@@ -0,0 +1,189 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: pybind11 bindings for the camera classes, frames come back as
+ *        NumPy arrays that share memory with the cv::Mat they came from
+ */
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include "eeyore/boson.hpp"
+#include "eeyore/electro_optical.hpp"
+
+namespace py = pybind11;
+
+static py::dtype matDtype( const cv::Mat& frame )
+{
+  switch (frame.depth())
+    {
+    case CV_8U:  return py::dtype::of<uint8_t>();
+    case CV_8S:  return py::dtype::of<int8_t>();
+    case CV_16U: return py::dtype::of<uint16_t>();
+    case CV_16S: return py::dtype::of<int16_t>();
+    case CV_32S: return py::dtype::of<int32_t>();
+    case CV_32F: return py::dtype::of<float>();
+    default:     return py::dtype::of<double>();
+    }
+}
+
+// the array keeps its own reference on the frame, so the pixels stay put
+// for as long as Python holds the array and are never copied
+static py::object matToArray( const cv::Mat& frame )
+{
+  if (frame.empty())
+    {
+      return py::none();
+    }
+
+  cv::Mat* owner = new cv::Mat(frame);
+  py::capsule release(owner, [](void* p) { delete (cv::Mat*)p; });
+
+  std::vector<py::ssize_t> shape = { owner->rows, owner->cols };
+  std::vector<py::ssize_t> strides = { (py::ssize_t)owner->step[0], (py::ssize_t)owner->elemSize() };
+
+  if (owner->channels() > 1)
+    {
+      shape.push_back(owner->channels());
+      strides.push_back(owner->elemSize1());
+    }
+
+  return py::array(matDtype(*owner), shape, strides, owner->data, release);
+}
+
+static py::dict statsToDict( const FrameStatsSnapshot& stats )
+{
+  py::dict d;
+  d["delivered"] = stats.delivered;
+  d["dropped"] = stats.dropped;
+  d["incomplete"] = stats.incomplete;
+  d["late"] = stats.late;
+  d["mean_interval_us"] = stats.mean_interval_us;
+  d["jitter_us"] = stats.jitter_us;
+  d["max_interval_us"] = stats.max_interval_us;
+  return d;
+}
+
+static py::dict telemetryToDict( const BosonTelemetry& telemetry )
+{
+  py::dict d;
+  d["fpa_temp_c"] = telemetry.fpa_temp_c;
+  d["ffc_in_progress"] = telemetry.ffc_in_progress;
+  d["last_ffc_frame"] = telemetry.last_ffc_frame;
+  d["sync_mode"] = telemetry.sync_mode;
+  d["sample_time_us"] = telemetry.sample_time_us;
+  d["samples"] = telemetry.samples;
+  d["errors"] = telemetry.errors;
+  d["valid"] = telemetry.valid;
+  return d;
+}
+
+static py::dict metadataToDict( const FrameMetadata& metadata )
+{
+  py::dict d;
+  d["timestamp"] = metadata.timestamp;
+  d["frame_id"] = metadata.frame_id;
+  d["exposure_time"] = metadata.exposure_time;
+  d["gain"] = metadata.gain;
+  d["arrival_us"] = metadata.arrival_us;
+  d["valid"] = metadata.valid;
+  return d;
+}
+
+PYBIND11_MODULE(eeyore, m)
+{
+  m.doc() = "EO/IR camera payload interface";
+
+  py::enum_<BosonFormat>(m, "BosonFormat")
+    .value("Y16", FORMAT_Y16)
+    .value("Y8", FORMAT_Y8)
+    .value("YUYV", FORMAT_YUYV)
+    .value("I420", FORMAT_I420);
+
+  py::enum_<BosonOutput>(m, "BosonOutput")
+    .value("GRAY", OUTPUT_GRAY)
+    .value("PALETTE_BGR", OUTPUT_PALETTE_BGR)
+    .value("PALETTE_RGBA", OUTPUT_PALETTE_RGBA)
+    .value("RAW16", OUTPUT_RAW16);
+
+  py::enum_<AcquisitionProfile>(m, "AcquisitionProfile")
+    .value("DEFAULT", PROFILE_DEFAULT)
+    .value("MAX_FPS", PROFILE_MAX_FPS)
+    .value("LOW_LATENCY", PROFILE_LOW_LATENCY)
+    .value("NO_DROPS", PROFILE_NO_DROPS);
+
+  py::enum_<DebayerMode>(m, "DebayerMode")
+    .value("NEAREST_NEIGHBOR", DEBAYER_NEAREST_NEIGHBOR)
+    .value("BILINEAR", DEBAYER_BILINEAR)
+    .value("HQ_LINEAR", DEBAYER_HQ_LINEAR)
+    .value("EDGE_SENSING", DEBAYER_EDGE_SENSING)
+    .value("DIRECTIONAL_FILTER", DEBAYER_DIRECTIONAL_FILTER);
+
+  py::class_<CalibrationStore>(m, "CalibrationStore")
+    .def(py::init<std::string>())
+    .def("open_cache", &CalibrationStore::openCache)
+    .def("write_cache", &CalibrationStore::writeCache)
+    .def("has_serial", &CalibrationStore::hasSerial)
+    .def("add_from_yaml", &CalibrationStore::addFromYaml);
+
+  // anything that can sit waiting on the device lets go of the GIL
+  py::class_<Boson>(m, "Boson")
+    .def(py::init<int32_t, int32_t, int, int, std::string, std::string>(),
+	 py::arg("serial_dev"), py::arg("serial_baud"), py::arg("width"), py::arg("height"),
+	 py::arg("video_id"), py::arg("sensor_name"))
+    .def("set_pixel_format", &Boson::setPixelFormat)
+    .def("set_output_mode", &Boson::setOutputMode)
+    .def("get_output_mode", &Boson::getOutputMode)
+    // takes the cv2.COLORMAP_* values
+    .def("set_palette", &Boson::setPalette, py::arg("colormap"))
+    .def("get_palette", &Boson::getPalette)
+    .def("set_nuc", &Boson::setNuc)
+    .def("set_rectify", &Boson::setRectify)
+    .def("load_nuc_tables", [](Boson& self, std::string file_path) { return self.getNucCorrector().loadTables(file_path); })
+    .def("open_sensor", &Boson::openSensor, py::call_guard<py::gil_scoped_release>())
+    .def("close_sensor", &Boson::closeSensor, py::call_guard<py::gil_scoped_release>())
+    .def("conduct_fcc", &Boson::conductFcc, py::call_guard<py::gil_scoped_release>())
+    .def("print_cam_info", &Boson::printCamInfo, py::call_guard<py::gil_scoped_release>())
+    .def("get_serial_number", &Boson::getSerialNumber, py::call_guard<py::gil_scoped_release>())
+    .def("load_calibration", &Boson::loadCalibration, py::keep_alive<1, 2>())
+    .def("get_frame", [](Boson& self)
+	 {
+	   cv::Mat frame;
+	   {
+	     py::gil_scoped_release release;
+	     frame = self.getFrame();
+	   }
+	   return matToArray(frame);
+	 })
+    .def("get_frame_stats", [](Boson& self) { return statsToDict(self.getFrameStats()); })
+    .def("get_last_frame_time", &Boson::getLastFrameTime)
+    .def("start_telemetry", &Boson::startTelemetry, py::arg("period_ms") = 1000)
+    .def("stop_telemetry", &Boson::stopTelemetry, py::call_guard<py::gil_scoped_release>())
+    .def("get_telemetry", [](Boson& self) { return telemetryToDict(self.getTelemetry()); });
+
+  py::class_<ElectroOpticalCam>(m, "ElectroOpticalCam")
+    .def(py::init<int, int, std::string>(), py::arg("height"), py::arg("width"), py::arg("trigger"),
+	 py::call_guard<py::gil_scoped_release>())
+    .def("configure_trigger", &ElectroOpticalCam::configureTrigger, py::call_guard<py::gil_scoped_release>())
+    .def("setup_camera", &ElectroOpticalCam::setupCamera, py::call_guard<py::gil_scoped_release>())
+    .def("set_acquisition_profile", &ElectroOpticalCam::setAcquisitionProfile, py::call_guard<py::gil_scoped_release>())
+    .def("set_debayer_mode", &ElectroOpticalCam::setDebayerMode)
+    .def("set_rectify", &ElectroOpticalCam::setRectify)
+    .def("start_camera", &ElectroOpticalCam::startCamera, py::call_guard<py::gil_scoped_release>())
+    .def("stop_camera", &ElectroOpticalCam::stopCamera, py::call_guard<py::gil_scoped_release>())
+    .def("close_device", &ElectroOpticalCam::closeDevice, py::call_guard<py::gil_scoped_release>())
+    .def("get_serial_number", &ElectroOpticalCam::getSerialNumberFromCam, py::call_guard<py::gil_scoped_release>())
+    .def("load_calibration", &ElectroOpticalCam::loadCalibration, py::keep_alive<1, 2>())
+    .def("get_frame", [](ElectroOpticalCam& self)
+	 {
+	   cv::Mat frame;
+	   FrameMetadata metadata = FrameMetadata();
+	   {
+	     py::gil_scoped_release release;
+	     frame = self.getFrame(metadata);
+	   }
+	   return py::make_tuple(matToArray(frame), metadataToDict(metadata));
+	 })
+    .def("get_frame_stats", [](ElectroOpticalCam& self) { return statsToDict(self.getFrameStats()); })
+    .def("get_achievable_frame_rate", &ElectroOpticalCam::getAchievableFrameRate);
+}
@@ -6,6 +6,7 @@
 #include "eeyore/boson.hpp"
 
 Boson::Boson( int32_t serial_dev, int32_t serial_baud, int width, int height, std::string video_id, std::string sensor_name )
+  : clock_sync_(600)
 {
   setSerialDev( serial_dev );
   setSerialBaud( serial_baud );
@@ -13,12 +14,38 @@ Boson::Boson( int32_t serial_dev, int32_t serial_baud, int width, int height, st
   setHeight( height );
   setVideoId( video_id );
   setSensorName( sensor_name );
+  setPixelFormat( FORMAT_Y16 );
+  setOutputMode( OUTPUT_GRAY );
   rectify_ = false;
+  nuc_enabled_ = false;
+  uart_open_ = false;
+  telemetry_running_ = false;
+  telemetry_period_ms_ = 1000;
+  // telemetry is never urgent, keep it out of the way of the frame path
+  telemetry_thread_config_.nice = 10;
+  last_device_us_ = 0.0;
+  last_dequeue_us_ = 0.0;
+
+  fd_ = -1;
+  buffer_start_ = NULL;
+  buffer_length_ = 0;
+  state_ = STREAM_CLOSED;
+  auto_reconnect_ = true;
+  reconnect_timeout_ms_ = 5000;
+  reconnect_stats_.reconnects = 0;
+  reconnect_stats_.failures = 0;
+  reconnect_stats_.last_latency_ms = 0.0;
+  reconnect_stats_.max_latency_ms = 0.0;
 }
 
 Boson::~Boson()
 {
-  exit(1);
+  stopTelemetry();
+
+  if (fd_ >= 0)
+    {
+      closeSensor();
+    }
 }
 
 void Boson::setSerialDev( int32_t serial_dev )
@@ -61,6 +88,63 @@ void Boson::setDistanceCoeffs( cv::Mat dist_coeffs )
   distance_coeffs_ = dist_coeffs;
 }
 
+void Boson::setOutputMode( BosonOutput mode )
+{
+  output_mode_ = mode;
+}
+
+void Boson::setPalette( int colormap )
+{
+  palette_.setPalette(colormap);
+}
+
+void Boson::setAutoReconnect( bool enable )
+{
+  auto_reconnect_ = enable;
+}
+
+void Boson::setReconnectTimeout( int timeout_ms )
+{
+  reconnect_timeout_ms_ = timeout_ms;
+}
+
+void Boson::setNuc( bool enable )
+{
+  nuc_enabled_ = enable;
+}
+
+void Boson::setTelemetryThreadConfig( ThreadConfig config )
+{
+  telemetry_thread_config_ = config;
+}
+
+void Boson::setExpectedFramePeriod( double period_us )
+{
+  stats_.setExpectedPeriod(period_us);
+}
+
+void Boson::setLateFactor( double factor )
+{
+  stats_.setLateFactor(factor);
+}
+
+void Boson::setPixelFormat( BosonFormat pixel_format )
+{
+  pixel_format_ = pixel_format;
+}
+
+void Boson::setRectifyMaps( cv::Mat map1, cv::Mat map2 )
+{
+  rectify_map1_ = map1;
+  rectify_map2_ = map2;
+  rectify_ = !map1.empty();
+}
+
+void Boson::setRectify( bool enable )
+{
+  rectify_ = enable && (!rectify_map1_.empty() || !intrinsic_coeffs_.empty());
+}
+
 int32_t Boson::getSerialDev()
 {
   return serial_dev_;
@@ -101,31 +185,137 @@ cv::Mat Boson::getDistanceCoeffs()
   return distance_coeffs_;
 }
 
+StreamState Boson::getStreamState()
+{
+  return state_;
+}
+
+ReconnectStats Boson::getReconnectStats()
+{
+  return reconnect_stats_;
+}
+
+BosonFormat Boson::getPixelFormat()
+{
+  return pixel_format_;
+}
+
+BosonOutput Boson::getOutputMode()
+{
+  return output_mode_;
+}
+
+int Boson::getPalette()
+{
+  return palette_.getPalette();
+}
+
+FrameStatsSnapshot Boson::getFrameStats()
+{
+  return stats_.getSnapshot();
+}
+
+void Boson::resetFrameStats()
+{
+  stats_.reset();
+}
+
+double Boson::getLastFrameTime()
+{
+  return clock_sync_.toHost(last_device_us_);
+}
+
+// V4L2 stamps the buffer on CLOCK_MONOTONIC, the same clock as ClockSync::hostNowUs
+double Boson::getLastBufferTime()
+{
+  return last_device_us_;
+}
+
+double Boson::getLastDequeueTime()
+{
+  return last_dequeue_us_;
+}
+
+bool Boson::getRectify()
+{
+  return rectify_;
+}
+
+bool Boson::getNuc()
+{
+  return nuc_enabled_;
+}
+
+NucCorrector& Boson::getNucCorrector()
+{
+  return nuc_;
+}
+
+BosonTelemetry Boson::getTelemetry()
+{
+  return telemetry_.load();
+}
+
+ThreadConfig Boson::getTelemetryThreadConfig()
+{
+  return telemetry_thread_config_;
+}
+
+double Boson::toHostTime( double device_us )
+{
+  return clock_sync_.toHost(device_us);
+}
+
 int Boson::openSensor()
 {
   struct v4l2_capability cap;
   std::cout << "[BOSON] Attempting to connect to camera" << std::endl;
 
+  // opening again, e.g. to pick up a new pixel format, starts from a closed
+  // stream so the old descriptor and mapping are not leaked
+  if (fd_ >= 0)
+    {
+      std::cout << "[BOSON] Sensor is already open, closing it first" << std::endl;
+      closeSensor();
+    }
+
   if ((fd_ = open(video_id_.c_str(), O_RDWR)) < 0 )
     { 
       perror("[BOSON] ERROR: Invalid video device");
-      exit(1);
+      releaseSensor();
+      return -1;
     }
   if (ioctl(fd_, VIDIOC_QUERYCAP, &cap) < 0)
     {
       perror("[BOSON] ERROR: VIDIOC_QUERYCAP Video Capture is not avaialable");
-      exit(1);
+      releaseSensor();
+      return -1;
     }
 
   if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE))
     {
       perror("[BOSON] ERROR: this device does not handle single-planar video capture");
-      exit(1);
+      releaseSensor();
+      return -1;
     }
   
   CLEAR(format_);
 
-  format_.fmt.pix.pixelformat = V4L2_PIX_FMT_Y16;
+  uint32_t v4l2_format = V4L2_PIX_FMT_Y16;
+  if (pixel_format_ == FORMAT_Y8)
+    {
+      v4l2_format = V4L2_PIX_FMT_GREY;
+    }
+  else if (pixel_format_ == FORMAT_YUYV)
+    {
+      v4l2_format = V4L2_PIX_FMT_YUYV;
+    }
+  else if (pixel_format_ == FORMAT_I420)
+    {
+      v4l2_format = V4L2_PIX_FMT_YUV420;
+    }
+
+  format_.fmt.pix.pixelformat = v4l2_format;
 
   format_.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
   format_.fmt.pix.width = width_;
@@ -134,7 +324,16 @@ int Boson::openSensor()
   if (ioctl(fd_, VIDIOC_S_FMT, &format_) < 0)
     {
       perror("[BOSON] ERROR: VIDIO_S_FMT");
-      exit(1);
+      releaseSensor();
+      return -1;
+    }
+
+  // the driver silently falls back to a format it supports
+  if (format_.fmt.pix.pixelformat != v4l2_format)
+    {
+      std::cerr << "[BOSON] ERROR: camera does not support the requested pixel format" << std::endl;
+      releaseSensor();
+      return -1;
     }
   
   struct v4l2_requestbuffers bufrequest;
@@ -145,7 +344,8 @@ int Boson::openSensor()
   if (ioctl(fd_, VIDIOC_REQBUFS, &bufrequest) < 0)
     {
       perror("[BOSON] ERROR: VIDIO_REQBUFS");
-      exit(1);
+      releaseSensor();
+      return -1;
     }
 
   memset(&bufferinfo_, 0, sizeof(bufferinfo_));
@@ -157,7 +357,8 @@ int Boson::openSensor()
   if (ioctl(fd_, VIDIOC_QUERYBUF, &bufferinfo_) < 0)
     {
       perror("[BOSON] ERROR: VIDIO_QUERTBUF");
-      exit(1);
+      releaseSensor();
+      return -1;
     }
 
   void *buffer_start = mmap(NULL, bufferinfo_.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, bufferinfo_.m.offset);
@@ -165,8 +366,11 @@ int Boson::openSensor()
   if (buffer_start == MAP_FAILED)
     {
       perror("[BOSON] ERROR: mmap failed");
-      exit(1);
+      releaseSensor();
+      return -1;
     }
+  buffer_start_ = buffer_start;
+  buffer_length_ = bufferinfo_.length;
 
   memset(buffer_start, 0, bufferinfo_.length);
 
@@ -175,14 +379,37 @@ int Boson::openSensor()
   if (ioctl(fd_, VIDIOC_STREAMON, &type) < 0)
     {
       perror("[BOSON] ERROR: VIDIOC_STREMON");
-      exit(1);
+      releaseSensor();
+      return -1;
     }
 
   
-  thermal16_ = cv::Mat(height_, width_, CV_16UC1, buffer_start);
-  thermal16_linear_ = cv::Mat(height_, width_, CV_8UC1, 1);
-  thermal16_out_ = cv::Mat(height_, width_, CV_16UC1, 1);
+  size_t stride = format_.fmt.pix.bytesperline;
+
+  if (pixel_format_ == FORMAT_Y16)
+    {
+      thermal16_ = cv::Mat(height_, width_, CV_16UC1, buffer_start);
+      thermal16_linear_ = cv::Mat(height_, width_, CV_8UC1, 1);
+    }
+  else
+    {
+      // the luma plane always comes first, for I420 the chroma planes follow it
+      if (pixel_format_ == FORMAT_YUYV)
+	{
+	  thermal8_ = cv::Mat(height_, width_, CV_8UC2, buffer_start, stride);
+	}
+      else if (pixel_format_ == FORMAT_I420)
+	{
+	  thermal8_ = cv::Mat(height_ * 3 / 2, width_, CV_8UC1, buffer_start, stride);
+	}
+      else
+	{
+	  thermal8_ = cv::Mat(height_, width_, CV_8UC1, buffer_start, stride);
+	}
+    }
+  output_pool_.clear();
 
+  state_ = STREAM_STREAMING;
   std::cout << "[BOSON] Successfully conected to camera" << std::endl;
   
   return 1;
@@ -190,118 +417,306 @@ int Boson::openSensor()
   
 int Boson::closeSensor()
 {
+  int result = EXIT_SUCCESS;
   int type = bufferinfo_.type;
 
-  if (ioctl(fd_, VIDIOC_STREAMOFF, &type) < 0)
+  if (fd_ >= 0 && ioctl(fd_, VIDIOC_STREAMOFF, &type) < 0)
     {
       perror("[BOSON] ERROR: VIDIOC_STREAMOFF");
-      exit(1);
+      result = -1;
     }
 
-  close(fd_);
+  releaseSensor();
+  state_ = STREAM_CLOSED;
 
   std::cout << "[BOSON] Exited cleanly" << std::endl;
 
-  return EXIT_SUCCESS;
+  return result;
 }
 
-cv::Mat Boson::getFrame()
+void Boson::releaseSensor()
+{
+  if (buffer_start_ != NULL)
+    {
+      munmap(buffer_start_, buffer_length_);
+      buffer_start_ = NULL;
+      buffer_length_ = 0;
+    }
+
+  if (fd_ >= 0)
+    {
+      close(fd_);
+      fd_ = -1;
+    }
+}
+
+int Boson::reconnect()
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point deadline = start + std::chrono::milliseconds(reconnect_timeout_ms_);
+  int backoff_ms = 50;
+
+  std::cout << "[BOSON] Lost the video stream, reconnecting" << std::endl;
+  state_ = STREAM_RECONNECTING;
+  releaseSensor();
+
+  // the device node comes back when the camera re-enumerates, no FFC is
+  // needed since the camera keeps its calibration across a USB reset
+  while (std::chrono::steady_clock::now() < deadline)
+    {
+      if (access(video_id_.c_str(), R_OK | W_OK) == 0 && openSensor() > 0)
+	{
+	  double latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	  reconnect_stats_.reconnects++;
+	  reconnect_stats_.last_latency_ms = latency_ms;
+	  if (latency_ms > reconnect_stats_.max_latency_ms)
+	    {
+	      reconnect_stats_.max_latency_ms = latency_ms;
+	    }
+
+	  std::cout << "[BOSON] Reconnected in " << latency_ms << " ms" << std::endl;
+	  return 0;
+	}
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+      backoff_ms = std::min(backoff_ms * 2, 500);
+    }
+
+  reconnect_stats_.failures++;
+  state_ = STREAM_FAILED;
+  std::cerr << "[BOSON] Unable to reconnect within " << reconnect_timeout_ms_ << " ms" << std::endl;
+
+  return -1;
+}
+
+int Boson::readBuffer()
 {
   // Put the buffer in the incoming queue.
   if (ioctl(fd_, VIDIOC_QBUF, &bufferinfo_) < 0)
     {
       perror("[BOSON] ERROR: VIDIOC_QBUF");
-      exit(1);
+      return -1;
     }
 
   // The buffer's waiting in the outgoing queue.
   if (ioctl(fd_, VIDIOC_DQBUF, &bufferinfo_) < 0)
     {
-      perror("[BOSON] ERROR: VIDIOC_QBUF");
-      exit(1);
-    } 
+      perror("[BOSON] ERROR: VIDIOC_DQBUF");
+      return -1;
+    }
 
-  grayScale16(thermal16_, thermal16_out_, height_, width_);
+  return 0;
+}
 
-  cv::Mat thermal16_final;
-  if (rectify_ == true)
+cv::Mat Boson::getFrame()
+{
+  if (state_ != STREAM_STREAMING)
     {
-      cv::undistort(thermal16_out_, thermal16_final, intrinsic_coeffs_, distance_coeffs_);
+      return cv::Mat();
     }
-  else
+
+  if (readBuffer() < 0)
     {
-      thermal16_final = thermal16_out_;
+      if (!auto_reconnect_ || reconnect() < 0 || readBuffer() < 0)
+	{
+	  return cv::Mat();
+	}
     }
-  return thermal16_final;
-}
 
-void Boson::grayScale16(Mat input_16, Mat output_16, int height, int width)
-{
-  // auxiliary variables for AGC calcultion
-  unsigned int max1 = 0;      // 16 bits
-  unsigned int min1 = 65535;      // 16 bits
-  unsigned int value1, value2;
-  size_t sizeInBytes = input_16.step[0] * input_16.rows;
+  // the driver counts every frame it sees, gaps mean nothing was queued for it
+  double stamp_us = bufferinfo_.timestamp.tv_sec * 1e6 + bufferinfo_.timestamp.tv_usec;
+  stats_.update(bufferinfo_.sequence, stamp_us, (bufferinfo_.flags & V4L2_BUF_FLAG_ERROR) != 0);
+  last_dequeue_us_ = ClockSync::hostNowUs();
+  clock_sync_.addSample(stamp_us, last_dequeue_us_);
+  last_device_us_ = stamp_us;
+
+  // the 8 bit formats are already through the camera's AGC, just pull out the luma
+  cv::Mat thermal_out;
+  bool rgba = output_mode_ == OUTPUT_PALETTE_RGBA;
+  int palette_type = rgba ? CV_8UC4 : CV_8UC3;
 
-  for (int i = 0; i < height; i++)
+  // software NUC and bad pixel replacement go ahead of any AGC
+  cv::Mat raw16 = thermal16_;
+  if (nuc_enabled_ && pixel_format_ == FORMAT_Y16)
     {
-      for (int j = 0; j < width; j++)
+      if (nuc_.apply(thermal16_, thermal16_nuc_) < 0)
 	{
-	  value1 = input_16.at<uint16_t>(i, j);
-	  if (value1 <= min1)
-	    {
-	      min1 = value1;
-	    }
-	  if (value1 >= max1)
-	    {
-	      max1 = value1;
-	    }
+	  cv::Mat gain = nuc_.getGain();
+	  std::cout << "[BOSON] NUC tables are " << gain.cols << "x" << gain.rows << " but the frame is "
+		    << thermal16_.cols << "x" << thermal16_.rows << ", disabling NUC" << std::endl;
+	  nuc_enabled_ = false;
+	}
+      else
+	{
+	  raw16 = thermal16_nuc_;
 	}
     }
 
-  for (int i = 0; i < height; i++)
+  bool palette = output_mode_ == OUTPUT_PALETTE_BGR || output_mode_ == OUTPUT_PALETTE_RGBA;
+
+  if (output_mode_ == OUTPUT_RAW16 && pixel_format_ == FORMAT_Y16)
+    {
+      thermal_out = nextOutputBuffer(CV_16UC1);
+      raw16.copyTo(thermal_out);
+    }
+  else if (palette && pixel_format_ == FORMAT_Y16)
+    {
+      // AGC and palette in one lookup, straight from the raw buffer
+      thermal_out = nextOutputBuffer(palette_type);
+      palette_.apply16(raw16, thermal_out, rgba);
+    }
+  else if (palette)
     {
-      for (int j = 0; j < width; j++)
+      cv::Mat luma;
+      if (pixel_format_ == FORMAT_YUYV)
+	{
+	  cv::extractChannel(thermal8_, luma, 0);
+	}
+      else
 	{
-	  value1 = input_16.at<uint16_t>(i, j);
-	  value2 = ((65535 * (value1 - min1))) / (max1 - min1);
-	  output_16.at<uint16_t>(i, j) = value2;
+	  luma = thermal8_.rowRange(0, height_);
 	}
+      thermal_out = nextOutputBuffer(palette_type);
+      palette_.apply8(luma, thermal_out, rgba);
+    }
+  else if (pixel_format_ == FORMAT_Y16)
+    {
+      thermal_out = nextOutputBuffer(CV_16UC1);
+      grayScale16(raw16, thermal_out);
+    }
+  else if (pixel_format_ == FORMAT_YUYV)
+    {
+      thermal_out = nextOutputBuffer(CV_8UC1);
+      cv::extractChannel(thermal8_, thermal_out, 0);
+    }
+  else
+    {
+      thermal_out = nextOutputBuffer(CV_8UC1);
+      thermal8_.rowRange(0, height_).copyTo(thermal_out);
     }
-}
-
-int Boson::conductFcc()
-{
-
-  std::cout << "[BOSON] Conducting flat field calibration" << std::endl;
-
-  FLR_RESULT result;
-  result = Initialize(serial_dev_, serial_baud_);
 
-  if (result)
+  cv::Mat thermal_final;
+  if (rectify_ == true && !rectify_map1_.empty())
     {
-      perror("[BOSON] Failed to initialize FFC");
-      Close();
-      return -1;
+      cv::remap(thermal_out, thermal_final, rectify_map1_, rectify_map2_, cv::INTER_LINEAR);
+    }
+  else if (rectify_ == true)
+    {
+      cv::undistort(thermal_out, thermal_final, intrinsic_coeffs_, distance_coeffs_);
     }
   else
     {
-      std::cout << "[BOSON] Intialized FFC successfully" << std::endl;
+      thermal_final = thermal_out;
+    }
+  return thermal_final;
+}
+
+cv::Mat Boson::nextOutputBuffer( int type )
+{
+  // reuse a buffer only once nobody outside the pool holds it, so a frame
+  // that was handed out is never written over underneath its owner. Holders
+  // on other threads drop their reference with an atomic add, so the count
+  // is read the same way rather than with a plain load
+  for (size_t i = 0; i < output_pool_.size(); i++)
+    {
+      cv::Mat& buffer = output_pool_[i];
+      if (buffer.u != NULL && CV_XADD(&buffer.u->refcount, 0) == 1 && buffer.type() == type)
+	{
+	  return buffer;
+	}
+    }
+
+  // past the limit the oldest buffer is forgotten, it is freed once its holder lets go
+  if (output_pool_.size() >= 8)
+    {
+      output_pool_.erase(output_pool_.begin());
     }
+  output_pool_.push_back(cv::Mat(height_, width_, type));
 
-  result = bosonRunFFC();
+  return output_pool_.back();
+}
 
-  if (result)
+void Boson::grayScale16(Mat input_16, Mat output_16)
+{
+  // AGC calcultion
+  double min_value, max_value;
+  cv::minMaxLoc(input_16, &min_value, &max_value);
+  unsigned int min1 = (unsigned int)min_value;
+  unsigned int max1 = (unsigned int)max_value;
+
+  // the exact integer stretch goes into a table over the frame's range, so
+  // max still lands on 65535 and the pass over the frame is just lookups.
+  // A flat frame maps to 0
+  agc_lut_.resize(max1 + 1);
+  std::fill(agc_lut_.begin(), agc_lut_.begin() + min1, 0);
+  for (unsigned int v = min1; v <= max1; v++)
     {
-      perror("[BOSON] Failed to run FFC");
-      return -1;
+      agc_lut_[v] = max1 > min1 ? (65535 * (v - min1)) / (max1 - min1) : 0;
     }
-  else
+
+  PixelPipeline< LutStage<uint16_t, uint16_t> > agc(LutStage<uint16_t, uint16_t>(&agc_lut_[0], agc_lut_.size()));
+  agc.run(input_16, output_16);
+}
+
+int Boson::conductFcc()
+{
+  int result = beginFcc();
+
+  if (result < 0)
     {
-      std::cout << "[BOSON] Successfully ran FFC" << std::endl;
+      return result;
     }
-  sleep(3);
-  Close();
+
+  return endFcc();
+}
+
+int Boson::beginFcc()
+{
+
+  std::cout << "[BOSON] Conducting flat field calibration" << std::endl;
+
+  FLR_RESULT result;
+
+  // the session is only held for the FFC command, not the settle time
+  {
+    UartSession uart(*this);
+    if (!uart.isOpen())
+      {
+	perror("[BOSON] Failed to initialize FFC");
+	return -1;
+      }
+    else
+      {
+	std::cout << "[BOSON] Intialized FFC successfully" << std::endl;
+      }
+
+    result = bosonRunFFC();
+
+    if (result)
+      {
+	perror("[BOSON] Failed to run FFC");
+	return -1;
+      }
+    else
+      {
+	std::cout << "[BOSON] Successfully ran FFC" << std::endl;
+      }
+  }
+  fcc_start_ = std::chrono::steady_clock::now();
+
+  return 0;
+}
+
+int Boson::endFcc()
+{
+  // the shutter needs 3 seconds from the start of the FFC to settle, anything
+  // done between beginFcc and endFcc (e.g. openSensor) comes off that time,
+  // though that is only the stream setup, the rest of the wait remains
+  std::this_thread::sleep_until(fcc_start_ + std::chrono::seconds(3));
+
+  // the camera just refreshed its own offsets, what the scene taught us is stale
+  nuc_.resetScene();
 
   return 0;
 }
@@ -310,12 +725,10 @@ int Boson::printCamInfo()
 {
   FLR_RESULT result;
 
-  result = Initialize(serial_dev_, serial_baud_);
-
-  if (result)
+  UartSession uart(*this);
+  if (!uart.isOpen())
     {
       std::cerr << "[BOSON] Failed to get camera info, aborting" << std::endl;
-      Close();
       return -1;
     }
 
@@ -326,7 +739,6 @@ int Boson::printCamInfo()
   if (result)
     {
       perror("[BOSON] Failed to get camera serial number, aborting");
-      Close();
       return -1;
     }
   else
@@ -341,7 +753,6 @@ int Boson::printCamInfo()
   if (result)
     {
       std::cerr << "[BOSON] Failed to get camera software info, aborting" << std::endl;
-      Close();
       return -1;
     }
   else
@@ -355,7 +766,6 @@ int Boson::printCamInfo()
   if (result)
     {
       perror("[BOSON] Failed to get part number info, aborting");
-      Close();
       return -1;
     }
   else
@@ -369,7 +779,6 @@ int Boson::printCamInfo()
   if(result)
     {
       std::cout << "[BOSON] Failed to get sync mode info, aborting" << std::endl;
-      Close();
       return -1;
     }
   else
@@ -387,20 +796,18 @@ int Boson::printCamInfo()
       std::cout << "[BOSON] Camera sync mode: " << sync_mode_str.c_str() << std::endl;
     }
 
-  Close();
   return 0;
 }
 
 std::string Boson::getSerialNumber()
 {
   FLR_RESULT result;
-  result = Initialize(serial_dev_, serial_baud_);
 
-  if (result)
+  UartSession uart(*this);
+  if (!uart.isOpen())
     {
       std::cerr << "[BOSON] Failed to get camera serial number, cant connect to camera, aborting" << std::endl;
-      Close();
-      exit(-1);
+      return "";
     }
 
   uint32_t serial_num;
@@ -410,32 +817,180 @@ std::string Boson::getSerialNumber()
   if (result)
     {
       perror("[BOSON] Failed to get camera serial number, aborting");
-      Close();
-      exit(-1);
+      return "";
     }
   else
     {
       serial_number_ = std::to_string(serial_num);
       std::cout << "[BOSON] Talking to camera with serial number: " << serial_number_ << std::endl;
     }
+
   return serial_number_;
 }
 
+int Boson::startTelemetry( int period_ms )
+{
+  if (telemetry_running_)
+    {
+      return 0;
+    }
+
+  telemetry_period_ms_ = std::max(period_ms, 1);
+  telemetry_running_ = true;
+  telemetry_thread_ = std::thread(&Boson::pollTelemetry, this);
+
+  std::cout << "[BOSON] Polling telemetry every " << telemetry_period_ms_ << " ms" << std::endl;
+
+  return 0;
+}
+
+void Boson::stopTelemetry()
+{
+  if (!telemetry_thread_.joinable())
+    {
+      return;
+    }
+
+  {
+    std::lock_guard<std::mutex> lock(telemetry_mutex_);
+    telemetry_running_ = false;
+  }
+  telemetry_wake_.notify_all();
+  telemetry_thread_.join();
+
+  // the session was only being held open for the poller
+  std::lock_guard<std::mutex> lock(uart_mutex_);
+  if (uart_open_)
+    {
+      Close();
+      uart_open_ = false;
+    }
+}
+
+void Boson::pollTelemetry()
+{
+  applyThreadConfig(telemetry_thread_config_);
+
+  BosonTelemetry telemetry = telemetry_.load();
+
+  while (telemetry_running_)
+    {
+      int16_t fpa_temp = 0;
+      int16_t ffc_in_progress = 0;
+      uint32_t last_ffc_frame = 0;
+      FLR_BOSON_EXT_SYNC_MODE_E sync_mode = FLR_BOSON_EXT_SYNC_MODE_E();
+
+      // the lock is taken per read, so a one shot command only ever waits
+      // out a single SDK call
+      bool ok = readUart(bosonlookupFPATempDegCx10, &fpa_temp)
+	&& readUart(bosonGetFFCInProgress, &ffc_in_progress)
+	&& readUart(bosonGetLastFFCFrameCount, &last_ffc_frame)
+	&& readUart(bosonGetExtSyncMode, &sync_mode);
+
+      if (ok)
+	{
+	  telemetry.fpa_temp_c = fpa_temp / 10.0;
+	  telemetry.ffc_in_progress = ffc_in_progress != 0;
+	  telemetry.last_ffc_frame = last_ffc_frame;
+	  telemetry.sync_mode = sync_mode;
+	  telemetry.sample_time_us = ClockSync::hostNowUs();
+	  telemetry.samples++;
+	  telemetry.valid = true;
+	}
+      else
+	{
+	  // keep the last good values, readers can tell how old they are
+	  telemetry.errors++;
+	}
+      telemetry_.store(telemetry);
+
+      std::unique_lock<std::mutex> lock(telemetry_mutex_);
+      telemetry_wake_.wait_for(lock, std::chrono::milliseconds(telemetry_period_ms_), [this]() { return !telemetry_running_; });
+    }
+}
+
+template <typename T>
+bool Boson::readUart( FLR_RESULT (*read)( T* ), T* value )
+{
+  UartSession uart(*this);
+  if (!uart.isOpen())
+    {
+      return false;
+    }
+
+  if (read(value))
+    {
+      // a failed read usually means a stale session, start a fresh one next time
+      uart.reset();
+      return false;
+    }
+  return true;
+}
+
+Boson::UartSession::UartSession( Boson& boson ) : boson_(boson), lock_(boson.uart_mutex_)
+{
+  if (boson_.uart_open_)
+    {
+      return;
+    }
+
+  if (Initialize(boson_.serial_dev_, boson_.serial_baud_))
+    {
+      Close();
+      return;
+    }
+  boson_.uart_open_ = true;
+}
+
+Boson::UartSession::~UartSession()
+{
+  // the telemetry thread keeps the session open between polls
+  if (boson_.uart_open_ && !boson_.telemetry_running_)
+    {
+      reset();
+    }
+}
+
+bool Boson::UartSession::isOpen()
+{
+  return boson_.uart_open_;
+}
+
+void Boson::UartSession::reset()
+{
+  Close();
+  boson_.uart_open_ = false;
+}
 
 cv::Mat Boson::getParams(std::string file_path, std::string data)
 {
-  cv::FileStorage fs(file_path, FileStorage::READ);
-  cv::Mat M;
-  fs[data] >> M;
+  return CalibrationStore::readYaml(file_path, data, "[BOSON]");
+}
 
-  if (M.rows == 0 || M.cols == 0)
+int Boson::loadCalibration( CalibrationStore& store )
+{
+  if (serial_number_.empty())
     {
-      std::cout << "[BOSON] Unable to load calibration file at: " << file_path << ", returning empty matrix" << std::endl;
-      return M;
+      getSerialNumber();
     }
-  else
+
+  if (!store.hasSerial(serial_number_))
     {
-      std::cout << "[BOSON] Found file with data type " << data <<", load matrix of size: (" << M.rows << "," <<M.cols << ")" << std::endl;
+      std::cout << "[BOSON] No calibration for serial number " << serial_number_ << " in " << store.getCachePath() << std::endl;
+      return -1;
     }
-  return M;
+
+  // the store hands out views into its mapping, the camera keeps its own
+  // copies so closing or reopening the store can't pull them out from under it
+  setIntrinsicCoeffs( store.getIntrinsicCoeffs(serial_number_).clone() );
+  setDistanceCoeffs( store.getDistanceCoeffs(serial_number_).clone() );
+
+  cv::Mat map1, map2;
+  if (store.getRectifyMaps(serial_number_, map1, map2) == 0 && map1.cols == width_ && map1.rows == height_)
+    {
+      setRectifyMaps( map1.clone(), map2.clone() );
+    }
+
+  std::cout << "[BOSON] Loaded calibration for serial number " << serial_number_ << std::endl;
+  return 0;
 }
@@ -0,0 +1,133 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Preallocated ring of raw frames for burst capture
+ */
+
+#include "eeyore/burst_buffer.hpp"
+
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+BurstBuffer::BurstBuffer()
+{
+  memory_ = NULL;
+  memory_bytes_ = 0;
+  slot_bytes_ = 0;
+  locked_ = false;
+  frame_count_ = 0;
+}
+
+BurstBuffer::~BurstBuffer()
+{
+  release();
+}
+
+int BurstBuffer::getSlotCount()
+{
+  return frames_.size();
+}
+
+size_t BurstBuffer::getSlotBytes()
+{
+  return slot_bytes_;
+}
+
+int BurstBuffer::getFrameCount()
+{
+  return frame_count_;
+}
+
+bool BurstBuffer::isLocked()
+{
+  return locked_;
+}
+
+BurstFrame& BurstBuffer::getFrame( int index )
+{
+  return frames_[index];
+}
+
+int BurstBuffer::allocate( int slot_count, size_t slot_bytes )
+{
+  release();
+
+  if (slot_count <= 0 || slot_bytes == 0)
+    {
+      std::cout << "[BURST] Invalid burst size" << std::endl;
+      return -1;
+    }
+
+  // keep every slot page aligned so the copies in run at full speed
+  size_t page = 4096;
+  slot_bytes_ = (slot_bytes + page - 1) & ~(page - 1);
+  memory_bytes_ = slot_bytes_ * slot_count;
+
+  void* memory = mmap(NULL, memory_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (memory == MAP_FAILED)
+    {
+      perror("[BURST] ERROR: unable to allocate burst buffer");
+      memory_bytes_ = 0;
+      slot_bytes_ = 0;
+      return -1;
+    }
+  memory_ = (uint8_t*)memory;
+
+  // lock and touch every page now, a page fault mid burst costs a frame
+  if (mlock(memory_, memory_bytes_) == 0)
+    {
+      locked_ = true;
+    }
+  else
+    {
+      perror("[BURST] WARNING: unable to lock burst buffer, check RLIMIT_MEMLOCK");
+      memset(memory_, 0, memory_bytes_);
+    }
+
+  frames_.resize(slot_count);
+  for (int i = 0; i < slot_count; i++)
+    {
+      memset(&frames_[i], 0, sizeof(BurstFrame));
+      frames_[i].data = memory_ + i * slot_bytes_;
+    }
+  frame_count_ = 0;
+
+  std::cout << "[BURST] Allocated " << slot_count << " slots of " << slot_bytes_ << " bytes" << std::endl;
+
+  return 0;
+}
+
+void BurstBuffer::release()
+{
+  if (memory_ != NULL)
+    {
+      if (locked_)
+	{
+	  munlock(memory_, memory_bytes_);
+	}
+      munmap(memory_, memory_bytes_);
+    }
+
+  memory_ = NULL;
+  memory_bytes_ = 0;
+  slot_bytes_ = 0;
+  locked_ = false;
+  frames_.clear();
+  frame_count_ = 0;
+}
+
+BurstFrame* BurstBuffer::nextSlot()
+{
+  if (frame_count_ >= (int)frames_.size())
+    {
+      return NULL;
+    }
+  return &frames_[frame_count_++];
+}
+
+void BurstBuffer::clear()
+{
+  frame_count_ = 0;
+}
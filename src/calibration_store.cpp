@@ -0,0 +1,360 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Shared calibration store backed by a binary cache file
+ */
+
+#include "eeyore/calibration_store.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fstream>
+
+// on disk layout: header, entry table, then the map data for each entry
+// aligned to CACHE_ALIGN so the maps can be used directly out of the mapping
+static const char CACHE_MAGIC[8] = {'E','E','Y','O','R','E','C','L'};
+static const uint32_t CACHE_VERSION = 1;
+static const size_t CACHE_ALIGN = 64;
+static const int MAX_DIST_COEFFS = 14;
+
+struct CacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t count;
+};
+
+struct CacheEntry
+{
+  char serial[32];
+  int32_t width;
+  int32_t height;
+  int32_t num_dist;
+  int32_t has_maps;
+  double intrinsic[9];
+  double distance[MAX_DIST_COEFFS];
+  uint64_t map1_offset;
+  uint64_t map2_offset;
+};
+
+static size_t alignUp( size_t value )
+{
+  return (value + CACHE_ALIGN - 1) & ~(CACHE_ALIGN - 1);
+}
+
+CalibrationStore::CalibrationStore( std::string cache_path )
+{
+  cache_path_ = cache_path;
+  mapped_ = NULL;
+  mapped_size_ = 0;
+}
+
+CalibrationStore::~CalibrationStore()
+{
+  closeCache();
+}
+
+std::string CalibrationStore::getCachePath()
+{
+  return cache_path_;
+}
+
+bool CalibrationStore::hasSerial( std::string serial )
+{
+  return entries_.find(serial) != entries_.end();
+}
+
+cv::Mat CalibrationStore::getIntrinsicCoeffs( std::string serial )
+{
+  std::map<std::string, Entry>::iterator it = entries_.find(serial);
+
+  if (it == entries_.end())
+    {
+      std::cout << "[CALIBRATION] No calibration for serial number " << serial << ", returning empty matrix" << std::endl;
+      return cv::Mat();
+    }
+  return it->second.intrinsic_coeffs;
+}
+
+cv::Mat CalibrationStore::getDistanceCoeffs( std::string serial )
+{
+  std::map<std::string, Entry>::iterator it = entries_.find(serial);
+
+  if (it == entries_.end())
+    {
+      std::cout << "[CALIBRATION] No calibration for serial number " << serial << ", returning empty matrix" << std::endl;
+      return cv::Mat();
+    }
+  return it->second.distance_coeffs;
+}
+
+int CalibrationStore::getRectifyMaps( std::string serial, cv::Mat& map1, cv::Mat& map2 )
+{
+  std::map<std::string, Entry>::iterator it = entries_.find(serial);
+
+  if (it == entries_.end() || it->second.map1.empty())
+    {
+      return -1;
+    }
+
+  map1 = it->second.map1;
+  map2 = it->second.map2;
+  return 0;
+}
+
+int CalibrationStore::openCache()
+{
+  closeCache();
+
+  int fd = open(cache_path_.c_str(), O_RDONLY);
+
+  if (fd < 0)
+    {
+      std::cout << "[CALIBRATION] No cache found at: " << cache_path_ << std::endl;
+      return -1;
+    }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(CacheHeader))
+    {
+      std::cout << "[CALIBRATION] Cache at " << cache_path_ << " is truncated, ignoring" << std::endl;
+      close(fd);
+      return -1;
+    }
+
+  void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (mapped == MAP_FAILED)
+    {
+      perror("[CALIBRATION] ERROR: mmap failed");
+      return -1;
+    }
+
+  const uint8_t* base = (const uint8_t*)mapped;
+  size_t size = st.st_size;
+  const CacheHeader* header = (const CacheHeader*)base;
+
+  if (memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header->version != CACHE_VERSION ||
+      header->count > (size - sizeof(CacheHeader)) / sizeof(CacheEntry))
+    {
+      std::cout << "[CALIBRATION] Cache at " << cache_path_ << " has an unknown format, ignoring" << std::endl;
+      munmap(mapped, size);
+      return -1;
+    }
+
+  const CacheEntry* table = (const CacheEntry*)(base + sizeof(CacheHeader));
+
+  for (uint32_t i = 0; i < header->count; i++)
+    {
+      const CacheEntry& ce = table[i];
+      std::string serial(ce.serial, strnlen(ce.serial, sizeof(ce.serial)));
+
+      // everything below comes from the file, check it before any Mat is built on it
+      if (ce.num_dist <= 0 || ce.num_dist > MAX_DIST_COEFFS || ce.width < 0 || ce.height < 0 ||
+	  (ce.has_maps && (ce.width == 0 || ce.height == 0)))
+	{
+	  std::cout << "[CALIBRATION] Entry for serial number " << serial << " is corrupt, skipping" << std::endl;
+	  continue;
+	}
+
+      Entry entry;
+      entry.width = ce.width;
+      entry.height = ce.height;
+
+      // the mapping is read only, these headers must never be written through
+      entry.intrinsic_coeffs = cv::Mat(3, 3, CV_64F, (void*)ce.intrinsic);
+      entry.distance_coeffs = cv::Mat(1, ce.num_dist, CV_64F, (void*)ce.distance);
+
+      if (ce.has_maps)
+	{
+	  size_t map1_bytes = (size_t)ce.width * ce.height * 4;
+	  size_t map2_bytes = (size_t)ce.width * ce.height * 2;
+
+	  if (ce.map1_offset > size || map1_bytes > size - ce.map1_offset ||
+	      ce.map2_offset > size || map2_bytes > size - ce.map2_offset)
+	    {
+	      std::cout << "[CALIBRATION] Maps for serial number " << serial << " are truncated, skipping" << std::endl;
+	      continue;
+	    }
+	  entry.map1 = cv::Mat(ce.height, ce.width, CV_16SC2, (void*)(base + ce.map1_offset));
+	  entry.map2 = cv::Mat(ce.height, ce.width, CV_16UC1, (void*)(base + ce.map2_offset));
+	}
+
+      entries_[serial] = entry;
+    }
+
+  mapped_ = mapped;
+  mapped_size_ = size;
+
+  std::cout << "[CALIBRATION] Loaded " << entries_.size() << " calibrations from: " << cache_path_ << std::endl;
+
+  return 0;
+}
+
+void CalibrationStore::closeCache()
+{
+  if (mapped_ != NULL)
+    {
+      // drop anything that points into the mapping before it goes away
+      entries_.clear();
+      munmap(mapped_, mapped_size_);
+      mapped_ = NULL;
+      mapped_size_ = 0;
+    }
+}
+
+int CalibrationStore::writeCache()
+{
+  std::vector<CacheEntry> table;
+  std::vector<const Entry*> sources;
+  size_t offset = alignUp(sizeof(CacheHeader) + entries_.size() * sizeof(CacheEntry));
+
+  for (std::map<std::string, Entry>::iterator it = entries_.begin(); it != entries_.end(); ++it)
+    {
+      const Entry& entry = it->second;
+      CacheEntry ce;
+      memset(&ce, 0, sizeof(ce));
+
+      if (it->first.size() >= sizeof(ce.serial))
+	{
+	  std::cout << "[CALIBRATION] Serial number " << it->first << " is too long, skipping" << std::endl;
+	  continue;
+	}
+      strncpy(ce.serial, it->first.c_str(), sizeof(ce.serial) - 1);
+
+      ce.width = entry.width;
+      ce.height = entry.height;
+      ce.num_dist = (int32_t)entry.distance_coeffs.total();
+
+      cv::Mat K, D;
+      entry.intrinsic_coeffs.convertTo(K, CV_64F);
+      entry.distance_coeffs.reshape(1, 1).convertTo(D, CV_64F);
+      memcpy(ce.intrinsic, K.ptr<double>(), sizeof(ce.intrinsic));
+      memcpy(ce.distance, D.ptr<double>(), ce.num_dist * sizeof(double));
+
+      if (!entry.map1.empty())
+	{
+	  ce.has_maps = 1;
+	  ce.map1_offset = offset;
+	  offset = alignUp(offset + entry.map1.total() * entry.map1.elemSize());
+	  ce.map2_offset = offset;
+	  offset = alignUp(offset + entry.map2.total() * entry.map2.elemSize());
+	}
+
+      table.push_back(ce);
+      sources.push_back(&entry);
+    }
+
+  // write next to the old cache and rename, so a mapped cache is never truncated under us
+  std::string tmp_path = cache_path_ + ".tmp";
+  std::ofstream out(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+
+  if (!out)
+    {
+      std::cout << "[CALIBRATION] Unable to write cache at: " << tmp_path << std::endl;
+      return -1;
+    }
+
+  CacheHeader header;
+  memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.version = CACHE_VERSION;
+  header.count = table.size();
+
+  out.write((const char*)&header, sizeof(header));
+  if (!table.empty())
+    {
+      out.write((const char*)&table[0], table.size() * sizeof(CacheEntry));
+    }
+
+  for (size_t i = 0; i < table.size(); i++)
+    {
+      if (!table[i].has_maps)
+	{
+	  continue;
+	}
+
+      const cv::Mat maps[2] = { sources[i]->map1, sources[i]->map2 };
+      const uint64_t offsets[2] = { table[i].map1_offset, table[i].map2_offset };
+
+      for (int m = 0; m < 2; m++)
+	{
+	  out.seekp(offsets[m]);
+	  for (int r = 0; r < maps[m].rows; r++)
+	    {
+	      out.write((const char*)maps[m].ptr(r), maps[m].cols * maps[m].elemSize());
+	    }
+	}
+    }
+  out.close();
+
+  if (!out || rename(tmp_path.c_str(), cache_path_.c_str()) < 0)
+    {
+      perror("[CALIBRATION] ERROR: failed to write cache");
+      return -1;
+    }
+
+  std::cout << "[CALIBRATION] Wrote " << table.size() << " calibrations to: " << cache_path_ << std::endl;
+
+  return 0;
+}
+
+int CalibrationStore::addFromYaml( std::string serial, std::string yaml_path, int width, int height )
+{
+  cv::Mat K = readYaml(yaml_path, "K", "[CALIBRATION]");
+  cv::Mat D = readYaml(yaml_path, "D", "[CALIBRATION]");
+
+  if (K.empty() || D.empty())
+    {
+      return -1;
+    }
+
+  return addCalibration(serial, K, D, width, height);
+}
+
+int CalibrationStore::addCalibration( std::string serial, cv::Mat int_coeffs, cv::Mat dist_coeffs, int width, int height )
+{
+  if (int_coeffs.total() != 9 || dist_coeffs.total() > (size_t)MAX_DIST_COEFFS)
+    {
+      std::cout << "[CALIBRATION] Invalid calibration for serial number " << serial << std::endl;
+      return -1;
+    }
+
+  Entry entry;
+  entry.width = width;
+  entry.height = height;
+  int_coeffs.convertTo(entry.intrinsic_coeffs, CV_64F);
+  dist_coeffs.reshape(1, 1).convertTo(entry.distance_coeffs, CV_64F);
+
+  // a zero sized image means only K/D are stored
+  if (width > 0 && height > 0)
+    {
+      cv::initUndistortRectifyMap(entry.intrinsic_coeffs, entry.distance_coeffs, cv::Mat(), entry.intrinsic_coeffs,
+				  cv::Size(width, height), CV_16SC2, entry.map1, entry.map2);
+    }
+
+  entries_[serial] = entry;
+
+  return 0;
+}
+
+cv::Mat CalibrationStore::readYaml( std::string file_path, std::string data, std::string tag )
+{
+  cv::FileStorage fs(file_path, cv::FileStorage::READ);
+  cv::Mat M;
+  fs[data] >> M;
+
+  if (M.rows == 0 || M.cols == 0)
+    {
+      std::cout << tag << " Unable to load calibration file at: " << file_path << ", returning empty matrix" << std::endl;
+      return M;
+    }
+  else
+    {
+      std::cout << tag << " Found file with data type " << data <<", load matrix of size: (" << M.rows << "," <<M.cols << ")" << std::endl;
+    }
+  return M;
+}
@@ -0,0 +1,192 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Online device to host clock estimator
+ */
+
+#include "eeyore/clock_sync.hpp"
+
+#include <time.h>
+
+// fewer samples than this and the drift estimate is mostly noise
+static const int MIN_SAMPLES = 8;
+
+ClockSync::ClockSync( int window )
+{
+  setWindow( window );
+}
+
+void ClockSync::setWindow( int window )
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  window_ = window < MIN_SAMPLES ? MIN_SAMPLES : window;
+  device_.assign(window_, 0.0);
+  host_.assign(window_, 0.0);
+  head_ = 0;
+  count_ = 0;
+  since_rebase_ = 0;
+  sum_x_ = sum_y_ = sum_xx_ = sum_xy_ = 0.0;
+  ref_device_ = ref_host_ = 0.0;
+  slope_ = 1.0;
+  intercept_ = 0.0;
+  min_residual_ = 0.0;
+}
+
+int ClockSync::getWindow()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return window_;
+}
+
+int ClockSync::getSampleCount()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_;
+}
+
+double ClockSync::getOffset()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ref_host_ + intercept_ + min_residual_ - ref_device_;
+}
+
+double ClockSync::getDrift()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (slope_ - 1.0) * 1e6;
+}
+
+bool ClockSync::isValid()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_ >= MIN_SAMPLES;
+}
+
+void ClockSync::addSample( double device_us, double host_us )
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (count_ == 0)
+    {
+      ref_device_ = device_us;
+      ref_host_ = host_us;
+    }
+
+  // drop the oldest sample from the sums once the window is full
+  if (count_ == window_)
+    {
+      double x = device_[head_] - ref_device_;
+      double y = host_[head_] - ref_host_;
+      sum_x_ -= x;
+      sum_y_ -= y;
+      sum_xx_ -= x * x;
+      sum_xy_ -= x * y;
+    }
+  else
+    {
+      count_++;
+    }
+
+  device_[head_] = device_us;
+  host_[head_] = host_us;
+  head_ = (head_ + 1) % window_;
+
+  double x = device_us - ref_device_;
+  double y = host_us - ref_host_;
+  sum_x_ += x;
+  sum_y_ += y;
+  sum_xx_ += x * x;
+  sum_xy_ += x * y;
+
+  // once a window has gone by, move the reference up and recompute the sums
+  // from scratch, this keeps the cost O(1) per frame on average. While the
+  // window is still filling the fit is redone each time the sample count
+  // doubles, so it settles quickly without going quadratic
+  bool filling = count_ < window_ && count_ >= MIN_SAMPLES && (count_ & (count_ - 1)) == 0;
+  if (++since_rebase_ >= window_ || filling)
+    {
+      refit();
+      return;
+    }
+
+  // the lower envelope is the frame that got through fastest, keep the
+  // mapping on it so queueing delay does not bias the offset. The line is
+  // frozen between refits, so every residual is against the same fit
+  double residual = y - (intercept_ + slope_ * x);
+  if (residual < min_residual_)
+    {
+      min_residual_ = residual;
+    }
+}
+
+void ClockSync::refit()
+{
+  int oldest = (head_ - count_ + window_) % window_;
+  double new_ref_device = device_[oldest];
+  double new_ref_host = host_[oldest];
+
+  sum_x_ = sum_y_ = sum_xx_ = sum_xy_ = 0.0;
+  for (int i = 0; i < count_; i++)
+    {
+      int idx = (oldest + i) % window_;
+      double x = device_[idx] - new_ref_device;
+      double y = host_[idx] - new_ref_host;
+      sum_x_ += x;
+      sum_y_ += y;
+      sum_xx_ += x * x;
+      sum_xy_ += x * y;
+    }
+
+  ref_device_ = new_ref_device;
+  ref_host_ = new_ref_host;
+  since_rebase_ = 0;
+
+  double n = count_;
+  double denom = n * sum_xx_ - sum_x_ * sum_x_;
+
+  if (denom > 0.0)
+    {
+      slope_ = (n * sum_xy_ - sum_x_ * sum_y_) / denom;
+      intercept_ = (sum_y_ - slope_ * sum_x_) / n;
+    }
+
+  min_residual_ = 0.0;
+  for (int i = 0; i < count_; i++)
+    {
+      int idx = (oldest + i) % window_;
+      double residual = (host_[idx] - ref_host_) - (intercept_ + slope_ * (device_[idx] - ref_device_));
+      if (residual < min_residual_)
+	{
+	  min_residual_ = residual;
+	}
+    }
+}
+
+double ClockSync::toHost( double device_us )
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ref_host_ + intercept_ + min_residual_ + slope_ * (device_us - ref_device_);
+}
+
+void ClockSync::reset()
+{
+  setWindow( getWindow() );
+}
+
+double ClockSync::hostNowUs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+double ClockSync::hostToWallUs( double host_us )
+{
+  // ROS time runs on the wall clock, carry the current monotonic to wall offset over
+  struct timespec mono, wall;
+  clock_gettime(CLOCK_MONOTONIC, &mono);
+  clock_gettime(CLOCK_REALTIME, &wall);
+
+  double offset = (wall.tv_sec - mono.tv_sec) * 1e6 + (wall.tv_nsec - mono.tv_nsec) / 1e3;
+  return host_us + offset;
+}
@@ -5,7 +5,15 @@
 
 #include "eeyore/electro_optical.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
 ElectroOpticalCam::ElectroOpticalCam( int h, int w, std::string t )
+  : clock_sync_(600)
 {
   TriggerType trig;
 
@@ -13,6 +21,10 @@ ElectroOpticalCam::ElectroOpticalCam( int h, int w, std::string t )
     {
       trig = SOFTWARE;
     }
+  else if (t == "SOFTWARE_PIPELINED")
+    {
+      trig = SOFTWARE_PIPELINED;
+    }
   else if (t == "HARDWARE_LINE0")
     {
       trig = HARDWARE_LINE0;
@@ -31,43 +43,197 @@ ElectroOpticalCam::ElectroOpticalCam( int h, int w, std::string t )
     }
   else
     {
-      std::cout << "[EO CAMERA] Invalid Trigger set, exiting" << std::endl;
-      exit(1);
+      throw std::invalid_argument("[EO CAMERA] Invalid trigger " + t);
     }	
   
   setHeight( h );
   setWidth( w );
   setTrigger( trig );
   rectify_ = false;
+  debayer_mode_ = DEBAYER_HQ_LINEAR;
+  chunk_mode_ = false;
+  last_metadata_.valid = false;
+  last_metadata_.arrival_us = 0.0;
+  profile_ = PROFILE_DEFAULT;
+  target_frame_rate_ = 0.0;
+  stream_buffer_count_ = 0;
+  profile_defaults_saved_ = false;
+  triggers_in_flight_ = 2;
+  pending_triggers_ = 0;
+  trigger_spacing_us_ = 0.0;
+  last_trigger_us_ = 0.0;
+  initReconnect();
+
+  if (initCam() < 0)
+    {
+      throw std::runtime_error("[EO CAMERA] No cameras found");
+    }
+}
 
-  system_ = System::GetInstance();
+ElectroOpticalCam::ElectroOpticalCam()
+  : clock_sync_(600)
+{
+  setHeight( 0 );
+  setWidth( 0 );
+  setTrigger( SOFTWARE );
+  rectify_ = false;
+  debayer_mode_ = DEBAYER_HQ_LINEAR;
+  chunk_mode_ = false;
+  last_metadata_.valid = false;
+  last_metadata_.arrival_us = 0.0;
+  profile_ = PROFILE_DEFAULT;
+  target_frame_rate_ = 0.0;
+  stream_buffer_count_ = 0;
+  profile_defaults_saved_ = false;
+  triggers_in_flight_ = 2;
+  pending_triggers_ = 0;
+  trigger_spacing_us_ = 0.0;
+  last_trigger_us_ = 0.0;
+  initReconnect();
+}
 
-  cam_list_ = system_->GetCameras();
+void ElectroOpticalCam::initReconnect()
+{
+  state_ = STREAM_CLOSED;
+  auto_reconnect_ = true;
+  reconnect_timeout_ms_ = 5000;
+  reconnect_stats_.reconnects = 0;
+  reconnect_stats_.failures = 0;
+  reconnect_stats_.last_latency_ms = 0.0;
+  reconnect_stats_.max_latency_ms = 0.0;
+}
 
-  if (cam_list_.GetSize() == 0)
+static ColorProcessingAlgorithm debayerAlgorithm( DebayerMode mode )
+{
+  switch (mode)
     {
-      std::cout << "[EO CAMERA] No Cameras Found, exiting" << std::endl;
-      exit(1);
+    case DEBAYER_NEAREST_NEIGHBOR:   return SPINNAKER_COLOR_PROCESSING_ALGORITHM_NEAREST_NEIGHBOR;
+    case DEBAYER_BILINEAR:           return SPINNAKER_COLOR_PROCESSING_ALGORITHM_BILINEAR;
+    case DEBAYER_EDGE_SENSING:       return SPINNAKER_COLOR_PROCESSING_ALGORITHM_EDGE_SENSING;
+    case DEBAYER_DIRECTIONAL_FILTER: return SPINNAKER_COLOR_PROCESSING_ALGORITHM_DIRECTIONAL_FILTER;
+    default:                         return SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR;
     }
-  
-  cam_ = cam_list_.GetByIndex(0);
-  cam_->Init();
 }
 
-void ElectroOpticalCam::initCam()
+int ElectroOpticalCam::initCam()
 {  
-  system_ = System::GetInstance();
+  try
+    {
+      system_ = System::GetInstance();
+
+      cam_list_ = system_->GetCameras();
 
-  cam_list_ = system_->GetCameras();
+      if (cam_list_.GetSize() == 0)
+	{
+	  std::cout << "[EO CAMERA] No Cameras Found" << std::endl;
+	  cam_list_.Clear();
+	  return -1;
+	}
 
-  if (cam_list_.GetSize() == 0)
+      cam_ = cam_list_.GetByIndex(0);
+      cam_->Init();
+    }
+  catch (Spinnaker::Exception& e)
     {
-      std::cout << "[EO CAMERA] No Cameras Found, exiting" << std::endl;
-      exit(1);
+      std::cout << "[EO CAMERA] Error: " << e.what() << std::endl;
+      return -1;
     }
-  
-  cam_ = cam_list_.GetByIndex(0);
-  cam_->Init();
+
+  return 0;
+}
+
+int ElectroOpticalCam::reconnect()
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point deadline = start + std::chrono::milliseconds(reconnect_timeout_ms_);
+  int backoff_ms = 50;
+
+  std::cout << "[EO CAMERA] Lost the camera, reconnecting" << std::endl;
+  state_ = STREAM_RECONNECTING;
+
+  // the old handle is dead, tear it down and carry on whatever fails
+  try
+    {
+      if (cam_.IsValid() && cam_->IsInitialized())
+	{
+	  if (cam_->IsStreaming())
+	    {
+	      cam_ -> EndAcquisition();
+	    }
+	  cam_ -> DeInit();
+	}
+    }
+  catch (Spinnaker::Exception& e)
+    {
+      std::cout << "[EO CAMERA] Error releasing the lost camera: " << e.what() << std::endl;
+    }
+  cam_ = nullptr;
+  cam_list_.Clear();
+
+  while (std::chrono::steady_clock::now() < deadline)
+    {
+      try
+	{
+	  cam_list_ = system_->GetCameras();
+
+	  // come back to the same camera if we know which one it was
+	  CameraPtr cam;
+	  if (!serial_number_.empty())
+	    {
+	      cam = cam_list_.GetBySerial(serial_number_);
+	    }
+	  else if (cam_list_.GetSize() > 0)
+	    {
+	      cam = cam_list_.GetByIndex(0);
+	    }
+
+	  if (cam.IsValid())
+	    {
+	      cam -> Init();
+	      cam_ = cam;
+
+	      if (configureTrigger() == 0 && setupCamera() == 0 &&
+		  (profile_ == PROFILE_DEFAULT || setAcquisitionProfile(profile_) == 0) && startCamera() == 0)
+		{
+		  double latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		  reconnect_stats_.reconnects++;
+		  reconnect_stats_.last_latency_ms = latency_ms;
+		  if (latency_ms > reconnect_stats_.max_latency_ms)
+		    {
+		      reconnect_stats_.max_latency_ms = latency_ms;
+		    }
+
+		  // the device clock restarts with the camera
+		  clock_sync_.reset();
+
+		  std::cout << "[EO CAMERA] Reconnected in " << latency_ms << " ms" << std::endl;
+		  return 0;
+		}
+	    }
+	}
+      catch (Spinnaker::Exception& e)
+	{
+	  std::cout << "[EO CAMERA] Error: " << e.what() << std::endl;
+	}
+
+      cam_ = nullptr;
+      cam_list_.Clear();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+      backoff_ms = std::min(backoff_ms * 2, 500);
+    }
+
+  reconnect_stats_.failures++;
+  state_ = STREAM_FAILED;
+  std::cout << "[EO CAMERA] Unable to reconnect within " << reconnect_timeout_ms_ << " ms" << std::endl;
+
+  return -1;
+}
+
+bool ElectroOpticalCam::isInitialized()
+{
+  return cam_.IsValid() && cam_->IsInitialized();
 }
 
 void ElectroOpticalCam::setHeight( int h )
@@ -85,6 +251,52 @@ void ElectroOpticalCam::setTrigger( TriggerType t )
   trig_ = t;
 }
 
+void ElectroOpticalCam::setTargetFrameRate( double fps )
+{
+  target_frame_rate_ = fps;
+
+  // frames are late against the rate that was asked for, not the one measured
+  if (fps > 0.0)
+    {
+      stats_.setExpectedPeriod(1e6 / fps);
+    }
+}
+
+void ElectroOpticalCam::setStreamBufferCount( int count )
+{
+  stream_buffer_count_ = count;
+}
+
+void ElectroOpticalCam::setTriggersInFlight( int count )
+{
+  triggers_in_flight_ = count < 1 ? 1 : count;
+}
+
+void ElectroOpticalCam::setBurstThreadConfig( ThreadConfig config )
+{
+  burst_thread_config_ = config;
+}
+
+void ElectroOpticalCam::setAutoReconnect( bool enable )
+{
+  auto_reconnect_ = enable;
+}
+
+void ElectroOpticalCam::setReconnectTimeout( int timeout_ms )
+{
+  reconnect_timeout_ms_ = timeout_ms;
+}
+
+void ElectroOpticalCam::setExpectedFramePeriod( double period_us )
+{
+  stats_.setExpectedPeriod(period_us);
+}
+
+void ElectroOpticalCam::setLateFactor( double factor )
+{
+  stats_.setLateFactor(factor);
+}
+
 void ElectroOpticalCam::setIntrinsicCoeffs( cv::Mat int_coeffs )
 {
   intrinsic_coeffs_ = int_coeffs;
@@ -95,6 +307,25 @@ void ElectroOpticalCam::setDistanceCoeffs( cv::Mat dist_coeffs )
   distance_coeffs_ = dist_coeffs;
 }
 
+void ElectroOpticalCam::setRectifyMaps( cv::Mat map1, cv::Mat map2 )
+{
+  rectify_map1_ = map1;
+  rectify_map2_ = map2;
+  rectify_ = !map1.empty();
+}
+
+void ElectroOpticalCam::setRectify( bool enable )
+{
+  // rectification only runs off the maps, there is nothing to turn on without them
+  rectify_ = enable && !rectify_map1_.empty();
+}
+
+void ElectroOpticalCam::setDebayerMode( DebayerMode mode )
+{
+  debayer_mode_ = mode;
+  processor_.SetColorProcessing(debayerAlgorithm(mode));
+}
+
 int ElectroOpticalCam::getHeight()
 {
   return height_;
@@ -110,6 +341,60 @@ TriggerType ElectroOpticalCam::getTrigger()
   return trig_;
 }
 
+int ElectroOpticalCam::getTriggersInFlight()
+{
+  return triggers_in_flight_;
+}
+
+bool ElectroOpticalCam::getRectify()
+{
+  return rectify_;
+}
+
+DebayerMode ElectroOpticalCam::getDebayerMode()
+{
+  return debayer_mode_;
+}
+
+ThreadConfig ElectroOpticalCam::getBurstThreadConfig()
+{
+  return burst_thread_config_;
+}
+
+StreamState ElectroOpticalCam::getStreamState()
+{
+  return state_;
+}
+
+ReconnectStats ElectroOpticalCam::getReconnectStats()
+{
+  return reconnect_stats_;
+}
+
+AcquisitionProfile ElectroOpticalCam::getAcquisitionProfile()
+{
+  return profile_;
+}
+
+double ElectroOpticalCam::getAchievableFrameRate()
+{
+  double fps = 0.0;
+
+  try
+    {
+      if (IsReadable(cam_->AcquisitionResultingFrameRate))
+	{
+	  fps = cam_ -> AcquisitionResultingFrameRate.GetValue();
+	}
+    }
+  catch (Spinnaker::Exception& e)
+    {
+      std::cout << "[EO CAMERA] Error: " << e.what() << std::endl;
+    }
+
+  return fps;
+}
+
 cv::Mat ElectroOpticalCam::getIntrinsicCoeffs()
 {
   return intrinsic_coeffs_;
@@ -120,13 +405,67 @@ cv::Mat ElectroOpticalCam::getDistanceCoeffs()
   return distance_coeffs_;
 }
 
+FrameMetadata ElectroOpticalCam::getLastMetadata()
+{
+  return last_metadata_;
+}
+
+double ElectroOpticalCam::getLastFrameTime()
+{
+  return clock_sync_.toHost(last_metadata_.timestamp / 1000.0);
+}
+
+double ElectroOpticalCam::toHostTime( double device_us )
+{
+  return clock_sync_.toHost(device_us);
+}
+
+int ElectroOpticalCam::latchDeviceClock( double& device_us, double& host_us )
+{
+  // the clock fit pairs timestamps with arrival times, so it hides the
+  // transport delay. Latching reads the camera clock against the host
+  // directly, to within the round trip of the register read
+  try
+    {
+      if (!IsWritable(cam_->TimestampLatch) || !IsReadable(cam_->TimestampLatchValue))
+	{
+	  std::cout << "[EO CAMERA] Camera can't latch its timestamp" << std::endl;
+	  return -1;
+	}
+
+      double before_us = ClockSync::hostNowUs();
+      cam_ -> TimestampLatch.Execute();
+      double after_us = ClockSync::hostNowUs();
+
+      device_us = cam_ -> TimestampLatchValue.GetValue() / 1000.0;
+      host_us = (before_us + after_us) / 2.0;
+    }
+  catch (Spinnaker::Exception& e)
+    {
+      std::cout << "[EO CAMERA] Error: " << e.what() << std::endl;
+      return -1;
+    }
+
+  return 0;
+}
+
+FrameStatsSnapshot ElectroOpticalCam::getFrameStats()
+{
+  return stats_.getSnapshot();
+}
+
+void ElectroOpticalCam::resetFrameStats()
+{
+  stats_.reset();
+}
+
 int ElectroOpticalCam::configureTrigger()
 {
   int result = 0;
   
   try
     {
-      if (trig_ == SOFTWARE)
+      if (trig_ == SOFTWARE || trig_ == SOFTWARE_PIPELINED)
 	{
 	  std::cout << "[EO CAMERA] Configuring Software Trigger" << std::endl;
 	}
@@ -164,6 +503,27 @@ int ElectroOpticalCam::configureTrigger()
 
 	  std::cout << "[EO CAMERA] Trigger source set to software" << std::endl;
 	}
+      else if (trig_ == SOFTWARE_PIPELINED)
+	{
+	  if (!IsWritable(cam_->TriggerSource))
+	    {
+	      std::cout << "[EO CAMERA] Unable to set software trigger, aborting" << std::endl;
+	      return -1;
+	    }
+
+	  cam_ -> TriggerSource.SetValue(TriggerSource_Software);
+
+	  // accept the next trigger while the previous frame is still reading out
+	  if (!IsWritable(cam_->TriggerOverlap))
+	    {
+	      std::cout << "[EO CAMERA] Unable to set trigger overlap, aborting" << std::endl;
+	      return -1;
+	    }
+
+	  cam_ -> TriggerOverlap.SetValue(TriggerOverlap_ReadOut);
+
+	  std::cout << "[EO CAMERA] Trigger source set to pipelined software, " << triggers_in_flight_ << " frames in flight" << std::endl;
+	}
       else if (trig_ == HARDWARE_LINE0)
 	{
 	  if (!IsWritable(cam_->TriggerSource))
@@ -252,8 +612,283 @@ int ElectroOpticalCam::setupCamera()
       cam_ -> AcquisitionMode.SetValue(AcquisitionMode_Continuous);
       std::cout << "[EO CAMERA] Acquisition mode set to continuous" << std::endl;
 
-      processor_.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
-      
+      processor_.SetColorProcessing(debayerAlgorithm(debayer_mode_));
+
+      // chunk data rides along with each image, so the metadata costs no extra reads
+      chunk_mode_ = false;
+      if (IsWritable(cam_->ChunkModeActive))
+	{
+	  cam_ -> ChunkModeActive.SetValue(true);
+
+	  const ChunkSelectorEnums chunks[] = { ChunkSelector_Timestamp, ChunkSelector_ExposureTime,
+						ChunkSelector_Gain, ChunkSelector_FrameID };
+
+	  size_t count = sizeof(chunks) / sizeof(chunks[0]);
+	  size_t enabled = 0;
+	  for (size_t i = 0; i < count; i++)
+	    {
+	      cam_ -> ChunkSelector.SetValue(chunks[i]);
+
+	      if (!IsWritable(cam_->ChunkEnable))
+		{
+		  std::cout << "[EO CAMERA] Unable to enable chunk " << cam_->ChunkSelector.ToString() << std::endl;
+		  continue;
+		}
+	      cam_ -> ChunkEnable.SetValue(true);
+	      enabled++;
+	    }
+
+	  // the metadata is only marked valid when every field in it is real
+	  chunk_mode_ = enabled == count;
+	  if (chunk_mode_)
+	    {
+	      std::cout << "[EO CAMERA] Chunk data enabled" << std::endl;
+	    }
+	  else
+	    {
+	      std::cout << "[EO CAMERA] Only " << enabled << " of " << count << " chunks enabled, no frame metadata available" << std::endl;
+	    }
+	}
+      else
+	{
+	  std::cout << "[EO CAMERA] Unable to enable chunk mode, no frame metadata available" << std::endl;
+	}
+    }
+  catch (Spinnaker::Exception& e)
+    {
+      std::cout << "[EO CAMERA] Error: " << e.what() << std::endl;
+      result = -1;
+    }
+
+  return result;
+}
+
+// gives a buffer back to the stream once, safe to call again from an error path
+static void releaseImage( ImagePtr& image )
+{
+  if (!image.IsValid())
+    {
+      return;
+    }
+
+  try
+    {
+      image -> Release();
+    }
+  catch (Spinnaker::Exception& e)
+    {
+      std::cout << "[EO CAMERA] Unable to release image: " << e.what() << std::endl;
+    }
+  image = nullptr;
+}
+
+static int setStreamEnum( INodeMap& node_map, const char* node, const char* value )
+{
+  CEnumerationPtr mode = node_map.GetNode(node);
+
+  if (!IsWritable(mode))
+    {
+      std::cout << "[EO CAMERA] Unable to set " << node << std::endl;
+      return -1;
+    }
+
+  CEnumEntryPtr entry = mode -> GetEntryByName(value);
+
+  if (!IsReadable(entry))
+    {
+      std::cout << "[EO CAMERA] " << node << " does not support " << value << std::endl;
+      return -1;
+    }
+
+  mode -> SetIntValue(entry->GetValue());
+  return 0;
+}
+
+void ElectroOpticalCam::saveProfileDefaults( INodeMap& stream_map )
+{
+  // only the first profile sees the camera as it was, later ones would save our own settings
+  if (profile_defaults_saved_)
+    {
+      return;
+    }
+
+  default_frame_rate_enable_ = IsReadable(cam_->AcquisitionFrameRateEnable) ? cam_->AcquisitionFrameRateEnable.GetValue() : -1;
+  default_frame_rate_ = IsReadable(cam_->AcquisitionFrameRate) ? cam_->AcquisitionFrameRate.GetValue() : -1.0;
+  default_link_limit_ = IsReadable(cam_->DeviceLinkThroughputLimit) ? cam_->DeviceLinkThroughputLimit.GetValue() : -1;
+  default_exposure_upper_ = IsReadable(cam_->AutoExposureExposureTimeUpperLimit) ? cam_->AutoExposureExposureTimeUpperLimit.GetValue() : -1.0;
+  default_exposure_time_ = IsReadable(cam_->ExposureTime) ? cam_->ExposureTime.GetValue() : -1.0;
+
+  CEnumerationPtr handling = stream_map.GetNode("StreamBufferHandlingMode");
+  default_buffer_handling_ = IsReadable(handling) ? handling->GetCurrentEntry()->GetSymbolic().c_str() : "";
+
+  profile_defaults_saved_ = true;
+}
+
+int ElectroOpticalCam::restoreProfileDefaults( INodeMap& stream_map )
+{
+  int result = setStreamEnum(stream_map, "StreamBufferCountMode", "Auto");
+
+  if (!profile_defaults_saved_)
+    {
+      return result;
+    }
+
+  if (!default_buffer_handling_.empty() && setStreamEnum(stream_map, "StreamBufferHandlingMode", default_buffer_handling_.c_str()) < 0)
+    {
+      result = -1;
+    }
+
+  // the throughput limit and exposure go back first, they bound the frame rate
+  if (default_link_limit_ >= 0 && IsWritable(cam_->DeviceLinkThroughputLimit))
+    {
+      cam_ -> DeviceLinkThroughputLimit.SetValue(default_link_limit_);
+    }
+  if (default_exposure_upper_ >= 0.0 && IsWritable(cam_->AutoExposureExposureTimeUpperLimit))
+    {
+      cam_ -> AutoExposureExposureTimeUpperLimit.SetValue(default_exposure_upper_);
+    }
+  if (default_exposure_time_ >= 0.0 && IsWritable(cam_->ExposureTime))
+    {
+      cam_ -> ExposureTime.SetValue(default_exposure_time_);
+    }
+
+  if (default_frame_rate_enable_ >= 0 && IsWritable(cam_->AcquisitionFrameRateEnable))
+    {
+      cam_ -> AcquisitionFrameRateEnable.SetValue(default_frame_rate_enable_ != 0);
+    }
+  if (default_frame_rate_enable_ > 0 && default_frame_rate_ >= 0.0 && IsWritable(cam_->AcquisitionFrameRate))
+    {
+      double fps = std::min(default_frame_rate_, cam_->AcquisitionFrameRate.GetMax());
+      cam_ -> AcquisitionFrameRate.SetValue(std::max(fps, cam_->AcquisitionFrameRate.GetMin()));
+    }
+
+  std::cout << "[EO CAMERA] Acquisition settings restored to their defaults" << std::endl;
+
+  return result;
+}
+
+int ElectroOpticalCam::setAcquisitionProfile( AcquisitionProfile profile )
+{
+  int result = 0;
+
+  // the stream nodes are locked while acquiring, so this has to come before startCamera
+  try
+    {
+      INodeMap& stream_map = cam_ -> GetTLStreamNodeMap();
+
+      if (profile == PROFILE_DEFAULT)
+	{
+	  profile_ = profile;
+	  return restoreProfileDefaults(stream_map);
+	}
+
+      saveProfileDefaults(stream_map);
+
+      // let the camera use all of the link, the frame rate is checked against it below
+      if (IsWritable(cam_->DeviceLinkThroughputLimit))
+	{
+	  cam_ -> DeviceLinkThroughputLimit.SetValue(cam_->DeviceLinkThroughputLimit.GetMax());
+	}
+
+      if (!IsWritable(cam_->AcquisitionFrameRateEnable))
+	{
+	  std::cout << "[EO CAMERA] Unable to enable the frame rate control" << std::endl;
+	  return -1;
+	}
+      cam_ -> AcquisitionFrameRateEnable.SetValue(true);
+
+      // some models only expose the rate once the enable has latched, or not at all
+      if (!IsAvailable(cam_->AcquisitionFrameRate) || !IsReadable(cam_->AcquisitionFrameRate))
+	{
+	  std::cout << "[EO CAMERA] Unable to read the frame rate limits" << std::endl;
+	  return -1;
+	}
+
+      double fps = cam_ -> AcquisitionFrameRate.GetMax();
+
+      if (target_frame_rate_ > 0.0 && target_frame_rate_ < fps)
+	{
+	  fps = target_frame_rate_;
+	}
+
+      // the sensor can only reach the rate if the data fits through the link
+      if (IsReadable(cam_->DeviceLinkThroughputLimit) && IsReadable(cam_->PayloadSize))
+	{
+	  double link_fps = (double)cam_->DeviceLinkThroughputLimit.GetValue() / cam_->PayloadSize.GetValue();
+
+	  if (link_fps < fps)
+	    {
+	      std::cout << "[EO CAMERA] Link bandwidth limits the frame rate to " << link_fps << " fps" << std::endl;
+	      fps = link_fps;
+	    }
+	}
+
+      // keep the exposure inside the frame period so it cannot pull the rate down
+      double period_us = 1e6 / fps;
+
+      if (IsWritable(cam_->AutoExposureExposureTimeUpperLimit))
+	{
+	  double upper = std::min(period_us, cam_->AutoExposureExposureTimeUpperLimit.GetMax());
+	  cam_ -> AutoExposureExposureTimeUpperLimit.SetValue(std::max(upper, cam_->AutoExposureExposureTimeUpperLimit.GetMin()));
+	}
+      else if (IsWritable(cam_->ExposureTime) && cam_->ExposureTime.GetValue() > period_us)
+	{
+	  cam_ -> ExposureTime.SetValue(std::max(period_us, cam_->ExposureTime.GetMin()));
+	}
+
+      // the exposure change can move the limits, so clamp again before setting
+      if (!IsWritable(cam_->AcquisitionFrameRate))
+	{
+	  std::cout << "[EO CAMERA] Unable to set the frame rate" << std::endl;
+	  return -1;
+	}
+      fps = std::min(fps, cam_->AcquisitionFrameRate.GetMax());
+      fps = std::max(fps, cam_->AcquisitionFrameRate.GetMin());
+      cam_ -> AcquisitionFrameRate.SetValue(fps);
+
+      std::cout << "[EO CAMERA] Frame rate set to " << fps << " fps" << std::endl;
+
+      // newest only keeps a single frame around, the other profiles queue everything
+      const char* handling = "OldestFirst";
+      int buffers = 16;
+
+      if (profile == PROFILE_LOW_LATENCY)
+	{
+	  handling = "NewestOnly";
+	  buffers = 3;
+	}
+      else if (profile == PROFILE_NO_DROPS)
+	{
+	  buffers = 64;
+	}
+
+      if (stream_buffer_count_ > 0)
+	{
+	  buffers = stream_buffer_count_;
+	}
+
+      if (setStreamEnum(stream_map, "StreamBufferHandlingMode", handling) < 0 ||
+	  setStreamEnum(stream_map, "StreamBufferCountMode", "Manual") < 0)
+	{
+	  return -1;
+	}
+
+      CIntegerPtr buffer_count = stream_map.GetNode("StreamBufferCountManual");
+
+      if (!IsWritable(buffer_count))
+	{
+	  std::cout << "[EO CAMERA] Unable to set the stream buffer count" << std::endl;
+	  return -1;
+	}
+
+      int64_t count = std::min((int64_t)buffers, buffer_count->GetMax());
+      count = std::max(count, buffer_count->GetMin());
+      buffer_count -> SetValue(count);
+
+      std::cout << "[EO CAMERA] Stream buffers set to " << count << ", " << handling << std::endl;
+      std::cout << "[EO CAMERA] Achievable frame rate is " << getAchievableFrameRate() << " fps" << std::endl;
+
+      profile_ = profile;
     }
   catch (Spinnaker::Exception& e)
     {
@@ -268,9 +903,19 @@ int ElectroOpticalCam::startCamera()
 {
   int result = 0;
 
+  pending_triggers_ = 0;
+  last_trigger_us_ = 0.0;
+
   try
     {
+      // overlapping triggers have to wait out the exposure of the frame before them
+      if (trig_ == SOFTWARE_PIPELINED && IsReadable(cam_->ExposureTime))
+	{
+	  trigger_spacing_us_ = cam_ -> ExposureTime.GetValue();
+	}
+
       cam_ -> BeginAcquisition();
+      state_ = STREAM_STREAMING;
       std::cout << "[EO CAMERA] Camera has started" << std::endl;
     }
   catch (Spinnaker::Exception& e)
@@ -282,39 +927,194 @@ int ElectroOpticalCam::startCamera()
   return result;
 }	
   
+int ElectroOpticalCam::stopCamera()
+{
+  int result = 0;
+
+  try
+    {
+      if (isInitialized() && cam_->IsStreaming())
+	{
+	  cam_ -> EndAcquisition();
+	}
+      state_ = STREAM_CLOSED;
+      std::cout << "[EO CAMERA] Camera has stopped" << std::endl;
+    }
+  catch (Spinnaker::Exception& e)
+    {
+      std::cout << "[EO CAMERA] Error: " << e.what() << std::endl;
+      result = -1;
+    }
+
+  return result;
+}
+
+int ElectroOpticalCam::issueTriggers( bool wait )
+{
+  if (trig_ != SOFTWARE && trig_ != SOFTWARE_PIPELINED)
+    {
+      return 0;
+    }
+
+  if (!IsWritable(cam_->TriggerSoftware))
+    {
+      std::cout << "Unable to execute software trigger" << std::endl;
+      return -1;
+    }
+
+  if (trig_ == SOFTWARE)
+    {
+      cam_ -> TriggerSoftware.Execute();
+      return 0;
+    }
+
+  // a trigger sent while the previous frame is still exposing gets dropped by
+  // the camera, so space them by the exposure time. Only wait when nothing is
+  // in flight, otherwise leave the rest for the next call
+  while (pending_triggers_ < triggers_in_flight_)
+    {
+      double wait_us = last_trigger_us_ + trigger_spacing_us_ - ClockSync::hostNowUs();
+
+      if (wait_us > 0.0)
+	{
+	  if (!wait || pending_triggers_ > 0)
+	    {
+	      break;
+	    }
+	  usleep(wait_us);
+	}
+
+      cam_ -> TriggerSoftware.Execute();
+      last_trigger_us_ = ClockSync::hostNowUs();
+      pending_triggers_++;
+    }
+
+  return 0;
+}
+
+void ElectroOpticalCam::drainTriggers()
+{
+  // exposures triggered before the error may still be on their way, take them
+  // off the stream so they are not handed out as the frames of new triggers
+  int timeout_ms = frameTimeoutMs();
+
+  while (trig_ == SOFTWARE_PIPELINED && pending_triggers_ > 0 && cam_->IsValid())
+    {
+      try
+	{
+	  ImagePtr image = cam_ -> GetNextImage(timeout_ms);
+	  releaseImage(image);
+	  pending_triggers_--;
+	}
+      catch (Spinnaker::Exception& e)
+	{
+	  // nothing arrived in time, the rest of the triggers were lost
+	  std::cout << "[EO CAMERA] " << pending_triggers_ << " triggered frames never arrived" << std::endl;
+	  break;
+	}
+    }
+
+  pending_triggers_ = 0;
+}
+
+int ElectroOpticalCam::frameTimeoutMs()
+{
+  // a pipelined frame is due one exposure after its trigger, so a trigger the
+  // camera dropped is noticed after that instead of stalling for a second
+  if (trig_ == SOFTWARE_PIPELINED && trigger_spacing_us_ > 0.0)
+    {
+      return (int)(trigger_spacing_us_ / 1000.0) + 100;
+    }
+  return 1000;
+}
+
 cv::Mat ElectroOpticalCam::getFrame()
+{
+  return getFrame(last_metadata_);
+}
+
+cv::Mat ElectroOpticalCam::getFrame( FrameMetadata& metadata )
 {
   int result = 0;
   cv::Mat blank_image;
   cv::Mat cv_image;
+  ImagePtr image_result;
   ImagePtr image_converted;
 
-  processor_.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
+  if (state_ != STREAM_STREAMING)
+    {
+      return blank_image;
+    }
+
+  processor_.SetColorProcessing(debayerAlgorithm(debayer_mode_));
 
   try
     {
-    if (trig_ == SOFTWARE)
+      if (issueTriggers(true) < 0)
 	{
-	  if (!IsWritable(cam_->TriggerSoftware))
-	    {
-	      std::cout << "Unable to execute software trigger" << std::endl;
-	      return blank_image;
-        }
-	  cam_ -> TriggerSoftware.Execute();
+	  return blank_image;
 	}
 
-      ImagePtr image_result = cam_ -> GetNextImage(1000);
+      image_result = cam_ -> GetNextImage(frameTimeoutMs());
+      double arrival_us = ClockSync::hostNowUs();
+
+      // queue up the next exposure before the conversion so the two overlap
+      if (trig_ == SOFTWARE_PIPELINED)
+	{
+	  pending_triggers_--;
+	  issueTriggers(false);
+	}
+
+      // frame IDs come from the camera, so gaps are frames the host never saw
+      stats_.update(image_result->GetFrameID(), image_result->GetTimeStamp() / 1000.0, image_result->IsIncomplete());
 
     if (image_result->IsIncomplete())
 	{
 	  std::cout << "Image incomplete with status " << image_result->GetImageStatus() << "..." << std::endl;
 	}
             
-    image_converted = processor_.Convert(image_result, PixelFormat_BGR8);     
+      if (chunk_mode_)
+	{
+	  const ChunkData& chunk = image_result->GetChunkData();
+	  metadata.timestamp = chunk.GetTimestamp();
+	  metadata.frame_id = chunk.GetFrameID();
+	  metadata.exposure_time = chunk.GetExposureTime();
+	  metadata.gain = chunk.GetGain();
+	  metadata.arrival_us = arrival_us;
+	  metadata.valid = true;
+	}
+      else
+	{
+	  metadata.timestamp = image_result->GetTimeStamp();
+	  metadata.frame_id = image_result->GetFrameID();
+	  metadata.exposure_time = 0.0;
+	  metadata.gain = 0.0;
+	  metadata.arrival_us = arrival_us;
+	  metadata.valid = false;
+	}
+      last_metadata_ = metadata;
+      if (metadata.valid)
+	{
+	  trigger_spacing_us_ = metadata.exposure_time;
+	}
+      clock_sync_.addSample(metadata.timestamp / 1000.0, arrival_us);
+
+      image_converted = processor_.Convert(image_result, PixelFormat_BGR8);
+      // hand the buffer back to the stream, the converted image owns its own memory
+      releaseImage(image_result);
     }
   catch (Spinnaker::Exception& e)
     {
       std::cout << "[EO CAMERA] Error getting frame: " << e.what() << std::endl;
+      // a failed conversion must not keep the buffer from the stream
+      releaseImage(image_result);
+      // a timeout means a trigger was lost, start the pipeline over
+      drainTriggers();
+
+      if (auto_reconnect_ && !cam_->IsValid())
+	{
+	  reconnect();
+	}
       return blank_image;
     }
   //cv::imwrite("/home/dcist/data/test_ee.png", cv_image);
@@ -323,6 +1123,14 @@ cv::Mat ElectroOpticalCam::getFrame()
   unsigned int h = image_converted->GetHeight();
   unsigned int w = image_converted->GetWidth();
   cv_image = cv::Mat(h+image_converted->GetYPadding(), w+image_converted->GetXPadding(), CV_8UC3, image_converted->GetData(), image_converted->GetStride());
+
+  if (rectify_ == true && rectify_map1_.size() == cv_image.size())
+    {
+      // remap writes a fresh image, so no clone is needed here
+      cv::Mat rectified;
+      cv::remap(cv_image, rectified, rectify_map1_, rectify_map2_, cv::INTER_LINEAR);
+      return rectified;
+    }
    
   return cv_image.clone();
 }
@@ -332,24 +1140,26 @@ int ElectroOpticalCam::writeFrame(std::string filename)
 {
   int result = 0;
 
-  processor_.SetColorProcessing(SPINNAKER_COLOR_PROCESSING_ALGORITHM_HQ_LINEAR);
+  processor_.SetColorProcessing(debayerAlgorithm(debayer_mode_));
 
   std::ostringstream f_name;
 
   f_name << filename;
   
+  ImagePtr image_result;
+
   try
     {
-      if (trig_ == SOFTWARE)
+      issueTriggers(true);
+
+      image_result = cam_ -> GetNextImage(frameTimeoutMs());
+
+      if (trig_ == SOFTWARE_PIPELINED)
 	{
-	  if (!IsWritable(cam_->TriggerSoftware))
-	    {
-	      std::cout << "Unable to execute software trigger" << std::endl;
-	    }
-	  cam_ -> TriggerSoftware.Execute();
+	  pending_triggers_--;
 	}
 
-      ImagePtr image_result = cam_ -> GetNextImage(1000);
+      stats_.update(image_result->GetFrameID(), image_result->GetTimeStamp() / 1000.0, image_result->IsIncomplete());
 
       if (image_result->IsIncomplete())
 	{
@@ -357,12 +1167,15 @@ int ElectroOpticalCam::writeFrame(std::string filename)
 	}
             
       ImagePtr image_converted = processor_.Convert(image_result, PixelFormat_BGR8);
+      releaseImage(image_result);
 
       image_converted -> Save(f_name.str().c_str());
     }
   catch (Spinnaker::Exception& e)
     {
       std::cout << "[EO CAMERA] Error writing frame: " << e.what() << std::endl;
+      releaseImage(image_result);
+      drainTriggers();
       return -1;
     }
 
@@ -370,30 +1183,214 @@ int ElectroOpticalCam::writeFrame(std::string filename)
 }
 
 
+int ElectroOpticalCam::allocateBurst( int frames )
+{
+  size_t payload = 0;
+
+  try
+    {
+      payload = cam_ -> PayloadSize.GetValue();
+    }
+  catch (Spinnaker::Exception& e)
+    {
+      std::cout << "[EO CAMERA] Error: " << e.what() << std::endl;
+      return -1;
+    }
+
+  return burst_.allocate(frames, payload);
+}
+
+int ElectroOpticalCam::captureBurst( int frames )
+{
+  burst_.clear();
+
+  if (frames > burst_.getSlotCount())
+    {
+      std::cout << "[EO CAMERA] Burst of " << frames << " frames does not fit, call allocateBurst first" << std::endl;
+      return -1;
+    }
+
+  // only copy the raw buffer out of the stream, the debayer happens in flushBurst
+  int captured = 0;
+  int skipped = 0;
+  int max_skipped = std::max(frames, 10);
+  ImagePtr image_result;
+
+  try
+    {
+      while (captured < frames)
+	{
+	  if (issueTriggers(true) < 0)
+	    {
+	      break;
+	    }
+
+	  image_result = cam_ -> GetNextImage(frameTimeoutMs());
+
+	  if (trig_ == SOFTWARE_PIPELINED)
+	    {
+	      pending_triggers_--;
+	    }
+
+	  stats_.update(image_result->GetFrameID(), image_result->GetTimeStamp() / 1000.0, image_result->IsIncomplete());
+
+	  // every frame would be too big if the slots were sized for another ROI or format
+	  if (image_result->GetImageSize() > burst_.getSlotBytes())
+	    {
+	      std::cout << "[EO CAMERA] Frame of " << image_result->GetImageSize() << " bytes does not fit a burst slot of "
+			<< burst_.getSlotBytes() << " bytes, call allocateBurst again" << std::endl;
+	      releaseImage(image_result);
+	      if (captured == 0)
+		{
+		  return -1;
+		}
+	      break;
+	    }
+
+	  if (image_result->IsIncomplete())
+	    {
+	      releaseImage(image_result);
+	      if (++skipped >= max_skipped)
+		{
+		  std::cout << "[EO CAMERA] Giving up on the burst after " << skipped << " incomplete frames" << std::endl;
+		  break;
+		}
+	      continue;
+	    }
+
+	  BurstFrame* slot = burst_.nextSlot();
+	  slot->bytes = image_result->GetImageSize();
+	  slot->width = image_result->GetWidth();
+	  slot->height = image_result->GetHeight();
+	  slot->pixel_format = image_result->GetPixelFormat();
+	  slot->timestamp = image_result->GetTimeStamp();
+	  slot->frame_id = image_result->GetFrameID();
+	  memcpy(slot->data, image_result->GetData(), slot->bytes);
+
+	  releaseImage(image_result);
+	  captured++;
+	}
+    }
+  catch (Spinnaker::Exception& e)
+    {
+      std::cout << "[EO CAMERA] Error capturing burst: " << e.what() << std::endl;
+      releaseImage(image_result);
+      drainTriggers();
+    }
+
+  std::cout << "[EO CAMERA] Captured burst of " << captured << " frames, skipped " << skipped << " incomplete" << std::endl;
+
+  return captured;
+}
+
+int ElectroOpticalCam::flushBurst( std::string prefix, int threads )
+{
+  int count = burst_.getFrameCount();
+  threads = std::max(threads, 1);
+  std::vector<int> written(threads, 0);
+  std::vector<std::thread> workers;
+
+  // each worker gets its own processor and every threads-th frame
+  for (int t = 0; t < threads; t++)
+    {
+      workers.push_back(std::thread([this, t, threads, count, prefix, &written]()
+      {
+	applyThreadConfig(burst_thread_config_);
+
+	ImageProcessor processor;
+	processor.SetColorProcessing(debayerAlgorithm(debayer_mode_));
+
+	for (int i = t; i < count; i += threads)
+	  {
+	    BurstFrame& frame = burst_.getFrame(i);
+
+	    try
+	      {
+		ImagePtr raw = Image::Create(frame.width, frame.height, 0, 0, (PixelFormatEnums)frame.pixel_format, frame.data);
+		ImagePtr converted = processor.Convert(raw, PixelFormat_BGR8);
+
+		cv::Mat cv_image(converted->GetHeight(), converted->GetWidth(), CV_8UC3, converted->GetData(), converted->GetStride());
+
+		char filename[32];
+		snprintf(filename, sizeof(filename), "_%05d.png", i);
+
+		if (cv::imwrite(prefix + filename, cv_image))
+		  {
+		    written[t]++;
+		  }
+	      }
+	    catch (Spinnaker::Exception& e)
+	      {
+		std::cout << "[EO CAMERA] Error writing burst frame " << i << ": " << e.what() << std::endl;
+	      }
+	  }
+      }));
+    }
+
+  int total = 0;
+  for (int t = 0; t < threads; t++)
+    {
+      workers[t].join();
+      total += written[t];
+    }
+
+  std::cout << "[EO CAMERA] Wrote " << total << " of " << count << " burst frames" << std::endl;
+
+  return total;
+}
+
 cv::Mat ElectroOpticalCam::getParams(std::string file_path, std::string data)
 {
-  cv::FileStorage fs(file_path, cv::FileStorage::READ);
-  cv::Mat M;
-  fs[data] >> M;
+  return CalibrationStore::readYaml(file_path, data, "[EO CAMERA]");
+}
 
-  if (M.rows == 0 || M.cols == 0)
+int ElectroOpticalCam::loadCalibration( CalibrationStore& store )
+{
+  if (serial_number_.empty())
     {
-      std::cout << "[EO CAMERA] Unable to load calibration file at: " << file_path << ", returning empty matrix" << std::endl;
-      return M;
+      getSerialNumberFromCam();
     }
-  else
+
+  if (!store.hasSerial(serial_number_))
     {
-      std::cout << "[EO CAMERA] Found file with data type " << data <<", load matrix of size: (" << M.rows << "," <<M.cols << ")" << std::endl;
+      std::cout << "[EO CAMERA] No calibration for serial number " << serial_number_ << " in " << store.getCachePath() << std::endl;
+      return -1;
     }
-  return M;
+
+  // the store hands out views into its mapping, the camera keeps its own
+  // copies so closing or reopening the store can't pull them out from under it
+  setIntrinsicCoeffs( store.getIntrinsicCoeffs(serial_number_).clone() );
+  setDistanceCoeffs( store.getDistanceCoeffs(serial_number_).clone() );
+
+  cv::Mat map1, map2;
+  if (store.getRectifyMaps(serial_number_, map1, map2) == 0)
+    {
+      setRectifyMaps( map1.clone(), map2.clone() );
+    }
+
+  std::cout << "[EO CAMERA] Loaded calibration for serial number " << serial_number_ << std::endl;
+  return 0;
 }
 
 void ElectroOpticalCam::closeDevice()
 {
-  
-  cam_ -> EndAcquisition();
-  cam_ -> DeInit();
-  delete cam_;
+  try
+    {
+      if (isInitialized())
+	{
+	  if (cam_->IsStreaming())
+	    {
+	      cam_ -> EndAcquisition();
+	    }
+	  cam_ -> DeInit();
+	}
+    }
+  catch (Spinnaker::Exception& e)
+    {
+      std::cout << "[EO CAMERA] Error: " << e.what() << std::endl;
+    }
+  cam_ = nullptr;
+  state_ = STREAM_CLOSED;
   
   cam_list_.Clear();
   system_ -> ReleaseInstance();
@@ -0,0 +1,355 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Pool of JPEG/PNG encoders for the compressed output stage
+ */
+
+#include "eeyore/encoder_pool.hpp"
+#include "eeyore/pixel_pipeline.hpp"
+
+#include <chrono>
+#include <stdio.h>
+
+#ifdef EEYORE_HAVE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+// everything a worker reuses from frame to frame
+struct EncoderWorker
+{
+  std::vector<uint8_t> buffer;
+  std::vector<int> params;
+  // 8 bit stretch of 16 bit frames, JPEG can't take them raw
+  cv::Mat narrow;
+#ifdef EEYORE_HAVE_TURBOJPEG
+  tjhandle handle;
+#endif
+};
+
+EncoderPool::EncoderPool( int workers, EncodeFormat format )
+{
+  worker_count_ = std::max(workers, 1);
+  format_ = format;
+  jpeg_quality_ = 90;
+  png_compression_ = 1;
+  queue_depth_ = 2 * worker_count_;
+  reserve_bytes_ = 0;
+  busy_ = 0;
+  running_ = false;
+  next_sequence_ = 0;
+  encoded_ = 0;
+  dropped_ = 0;
+}
+
+EncoderPool::~EncoderPool()
+{
+  stop();
+}
+
+void EncoderPool::setJpegQuality( int quality )
+{
+  jpeg_quality_ = std::min(std::max(quality, 1), 100);
+}
+
+void EncoderPool::setPngCompression( int level )
+{
+  png_compression_ = std::min(std::max(level, 0), 9);
+}
+
+void EncoderPool::setQueueDepth( int frames )
+{
+  queue_depth_ = std::max(frames, 1);
+}
+
+void EncoderPool::setFrameSize( int width, int height, int channels )
+{
+  // worst case for either format, an incompressible PNG of 16 bit pixels
+  reserve_bytes_ = (size_t)width * height * channels * 2 + 65536;
+}
+
+void EncoderPool::setThreadConfig( ThreadConfig config )
+{
+  thread_config_ = config;
+}
+
+void EncoderPool::setCallback( std::function<void(const EncodedFrame&)> callback )
+{
+  callback_ = callback;
+}
+
+EncodeFormat EncoderPool::getFormat()
+{
+  return format_;
+}
+
+int EncoderPool::getJpegQuality()
+{
+  return jpeg_quality_;
+}
+
+int EncoderPool::getPngCompression()
+{
+  return png_compression_;
+}
+
+int EncoderPool::getQueueDepth()
+{
+  return queue_depth_;
+}
+
+uint64_t EncoderPool::getEncodedCount()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return encoded_;
+}
+
+uint64_t EncoderPool::getDroppedCount()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+int EncoderPool::start()
+{
+  if (running_)
+    {
+      return 0;
+    }
+
+  if (!callback_)
+    {
+      std::cout << "[ENCODER] Set a callback before starting, encoded frames have nowhere to go" << std::endl;
+      return -1;
+    }
+
+  for (int i = 0; i < worker_count_; i++)
+    {
+      std::unique_ptr<EncoderWorker> worker(new EncoderWorker());
+      worker->buffer.reserve(reserve_bytes_);
+#ifdef EEYORE_HAVE_TURBOJPEG
+      worker->handle = tjInitCompress();
+      if (worker->handle == NULL)
+	{
+	  std::cout << "[ENCODER] Failed to create a JPEG compressor" << std::endl;
+	  for (size_t j = 0; j < workers_.size(); j++)
+	    {
+	      tjDestroy(workers_[j]->handle);
+	    }
+	  workers_.clear();
+	  return -1;
+	}
+#endif
+      workers_.push_back(std::move(worker));
+    }
+
+  running_ = true;
+  for (int i = 0; i < worker_count_; i++)
+    {
+      threads_.push_back(std::thread(&EncoderPool::workerLoop, this, workers_[i].get()));
+    }
+
+  std::cout << "[ENCODER] Started " << worker_count_ << (format_ == ENCODE_JPEG ? " JPEG" : " PNG") << " encoders" << std::endl;
+
+  return 0;
+}
+
+void EncoderPool::stop()
+{
+  // workers finish whatever is queued before they exit
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  work_ready_.notify_all();
+
+  for (size_t i = 0; i < threads_.size(); i++)
+    {
+      threads_[i].join();
+    }
+  threads_.clear();
+
+#ifdef EEYORE_HAVE_TURBOJPEG
+  for (size_t i = 0; i < workers_.size(); i++)
+    {
+      tjDestroy(workers_[i]->handle);
+    }
+#endif
+  workers_.clear();
+}
+
+int EncoderPool::submit( const cv::Mat& frame, double timestamp_us )
+{
+  if (frame.empty())
+    {
+      return -1;
+    }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // never hold up the capture thread, a full queue drops the frame
+    if (!running_ || (int)queue_.size() >= queue_depth_)
+      {
+	dropped_++;
+	return -1;
+      }
+
+    EncodeJob job;
+    job.frame = frame;
+    job.sequence = next_sequence_++;
+    job.timestamp_us = timestamp_us;
+    queue_.push_back(job);
+  }
+  work_ready_.notify_one();
+
+  return 0;
+}
+
+void EncoderPool::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return queue_.empty() && busy_ == 0; });
+}
+
+void EncoderPool::workerLoop( EncoderWorker* worker )
+{
+  applyThreadConfig(thread_config_);
+
+  while (true)
+    {
+      EncodeJob job;
+      {
+	std::unique_lock<std::mutex> lock(mutex_);
+	work_ready_.wait(lock, [this]() { return !queue_.empty() || !running_; });
+
+	if (queue_.empty())
+	  {
+	    return;
+	  }
+	job = queue_.front();
+	queue_.pop_front();
+	busy_++;
+      }
+
+      EncodedFrame encoded;
+      int result = encode(worker, job, encoded);
+
+      if (result == 0)
+	{
+	  callback_(encoded);
+	}
+
+      // let go of the camera's frame before waiting on the next job
+      job.frame.release();
+
+      {
+	std::lock_guard<std::mutex> lock(mutex_);
+	busy_--;
+	if (result == 0)
+	  {
+	    encoded_++;
+	  }
+      }
+      work_done_.notify_all();
+    }
+}
+
+int EncoderPool::encode( EncoderWorker* worker, const EncodeJob& job, EncodedFrame& encoded )
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const cv::Mat* frame = &job.frame;
+
+  try
+    {
+      if (format_ == ENCODE_JPEG)
+	{
+	  if (frame->type() == CV_16UC1)
+	    {
+	      double min, max;
+	      cv::minMaxLoc(*frame, &min, &max);
+	      PixelPipeline< AgcStage<uint8_t> > agc(AgcStage<uint8_t>(min, max));
+	      agc.run(*frame, worker->narrow);
+	      frame = &worker->narrow;
+	    }
+
+	  if (frame->depth() != CV_8U || frame->channels() == 2)
+	    {
+	      std::cout << "[ENCODER] JPEG needs an 8 bit gray, BGR or BGRA frame" << std::endl;
+	      return -1;
+	    }
+
+#ifdef EEYORE_HAVE_TURBOJPEG
+	  int pixel_format = frame->channels() == 1 ? TJPF_GRAY : (frame->channels() == 4 ? TJPF_BGRA : TJPF_BGR);
+	  int subsampling = frame->channels() == 1 ? TJSAMP_GRAY : TJSAMP_420;
+
+	  // sized for the worst case once, so the compressor never reallocates
+	  unsigned long bytes = tjBufSize(frame->cols, frame->rows, subsampling);
+	  if (worker->buffer.size() < bytes)
+	    {
+	      worker->buffer.resize(bytes);
+	    }
+	  unsigned char* out = worker->buffer.data();
+
+	  if (tjCompress2(worker->handle, frame->data, frame->cols, frame->step, frame->rows, pixel_format,
+			  &out, &bytes, subsampling, jpeg_quality_, TJFLAG_NOREALLOC | TJFLAG_FASTDCT) < 0)
+	    {
+	      std::cout << "[ENCODER] JPEG compression failed: " << tjGetErrorStr2(worker->handle) << std::endl;
+	      return -1;
+	    }
+	  encoded.bytes = bytes;
+#else
+	  worker->params.assign({cv::IMWRITE_JPEG_QUALITY, jpeg_quality_});
+	  if (!cv::imencode(".jpg", *frame, worker->buffer, worker->params))
+	    {
+	      std::cout << "[ENCODER] JPEG compression failed" << std::endl;
+	      return -1;
+	    }
+	  encoded.bytes = worker->buffer.size();
+#endif
+	}
+      else
+	{
+	  // run length deflate at a low level is many times faster than the
+	  // defaults and still does well on thermal and flat scenes
+	  worker->params.assign({cv::IMWRITE_PNG_COMPRESSION, png_compression_,
+				 cv::IMWRITE_PNG_STRATEGY, cv::IMWRITE_PNG_STRATEGY_RLE});
+	  if (!cv::imencode(".png", *frame, worker->buffer, worker->params))
+	    {
+	      std::cout << "[ENCODER] PNG compression failed" << std::endl;
+	      return -1;
+	    }
+	  encoded.bytes = worker->buffer.size();
+	}
+    }
+  catch (cv::Exception& e)
+    {
+      std::cout << "[ENCODER] Error encoding frame " << job.sequence << ": " << e.what() << std::endl;
+      return -1;
+    }
+
+  encoded.data = worker->buffer.data();
+  encoded.sequence = job.sequence;
+  encoded.timestamp_us = job.timestamp_us;
+  encoded.format = format_;
+  encoded.encode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  return 0;
+}
+
+std::function<void(const EncodedFrame&)> EncoderPool::fileWriter( std::string prefix )
+{
+  return [prefix]( const EncodedFrame& encoded )
+    {
+      char filename[32];
+      snprintf(filename, sizeof(filename), "_%06llu.%s", (unsigned long long)encoded.sequence,
+	       encoded.format == ENCODE_JPEG ? "jpg" : "png");
+
+      FILE* file = fopen((prefix + filename).c_str(), "wb");
+      if (file == NULL)
+	{
+	  perror("[ENCODER] ERROR: Could not open output file");
+	  return;
+	}
+      fwrite(encoded.data, 1, encoded.bytes, file);
+      fclose(file);
+    };
+}
@@ -0,0 +1,454 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Shared memory frame bus for handing frames to other processes
+ */
+
+#include "eeyore/frame_bus.hpp"
+
+#include <atomic>
+#include <climits>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+static const char BUS_MAGIC[8] = {'E','E','Y','O','R','E','F','B'};
+static const uint32_t BUS_VERSION = 2;
+static const size_t BUS_ALIGN = 4096;
+
+// each slot is a seqlock, sequence is zero while the writer is filling it
+// and the frame's sequence number once it is published
+struct FrameBusSlot
+{
+  std::atomic<uint64_t> sequence;
+  int32_t rows;
+  int32_t cols;
+  int32_t type;
+  uint32_t flags;
+  uint64_t step;
+  double timestamp_us;
+};
+
+struct FrameBusHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t slot_count;
+  uint64_t slot_bytes;
+  uint64_t data_offset;
+
+  // sequence of the newest published frame, zero before the first one
+  std::atomic<uint64_t> write_sequence;
+  // bumped on every publish, readers sleep on it
+  std::atomic<uint32_t> futex_word;
+  // set once the writer closes the bus, the name may already point at a new one
+  std::atomic<uint32_t> closed;
+};
+
+static size_t alignUp( size_t value )
+{
+  return (value + BUS_ALIGN - 1) & ~(BUS_ALIGN - 1);
+}
+
+static FrameBusSlot* busSlots( const FrameBusHeader* header )
+{
+  return (FrameBusSlot*)((uint8_t*)header + sizeof(FrameBusHeader));
+}
+
+static uint8_t* busSlotData( const FrameBusHeader* header, uint64_t index )
+{
+  return (uint8_t*)header + header->data_offset + index * header->slot_bytes;
+}
+
+static int futexWait( const std::atomic<uint32_t>* word, uint32_t expected, int timeout_ms )
+{
+  struct timespec timeout;
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+
+  return syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, &timeout, NULL, 0);
+}
+
+static void futexWake( std::atomic<uint32_t>* word )
+{
+  syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+FrameBusWriter::FrameBusWriter( std::string name, int slot_count, size_t slot_bytes )
+{
+  name_ = name;
+  slot_count_ = slot_count;
+  slot_bytes_ = alignUp(slot_bytes);
+  header_ = NULL;
+  mapped_size_ = 0;
+  pending_sequence_ = 0;
+}
+
+FrameBusWriter::~FrameBusWriter()
+{
+  closeBus();
+}
+
+std::string FrameBusWriter::getName()
+{
+  return name_;
+}
+
+int FrameBusWriter::getSlotCount()
+{
+  return slot_count_;
+}
+
+size_t FrameBusWriter::getSlotBytes()
+{
+  return slot_bytes_;
+}
+
+int FrameBusWriter::openBus()
+{
+  if (slot_count_ <= 0)
+    {
+      std::cout << "[FRAME BUS] Need at least one slot" << std::endl;
+      return -1;
+    }
+
+  size_t data_offset = alignUp(sizeof(FrameBusHeader) + slot_count_ * sizeof(FrameBusSlot));
+  size_t size = data_offset + slot_count_ * slot_bytes_;
+
+  // start from a fresh segment so stale readers never see a half built ring
+  shm_unlink(name_.c_str());
+  int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+
+  if (fd < 0)
+    {
+      perror("[FRAME BUS] ERROR: shm_open failed");
+      return -1;
+    }
+
+  if (ftruncate(fd, size) < 0)
+    {
+      perror("[FRAME BUS] ERROR: ftruncate failed");
+      close(fd);
+      shm_unlink(name_.c_str());
+      return -1;
+    }
+
+  void* mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (mapped == MAP_FAILED)
+    {
+      perror("[FRAME BUS] ERROR: mmap failed");
+      shm_unlink(name_.c_str());
+      return -1;
+    }
+
+  header_ = (FrameBusHeader*)mapped;
+  mapped_size_ = size;
+
+  header_->version = BUS_VERSION;
+  header_->slot_count = slot_count_;
+  header_->slot_bytes = slot_bytes_;
+  header_->data_offset = data_offset;
+  header_->write_sequence.store(0);
+  header_->futex_word.store(0);
+  header_->closed.store(0);
+
+  FrameBusSlot* slots = busSlots(header_);
+  for (int i = 0; i < slot_count_; i++)
+    {
+      slots[i].sequence.store(0);
+    }
+
+  // readers check the magic last, so it goes in once everything else is set
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(header_->magic, BUS_MAGIC, sizeof(BUS_MAGIC));
+
+  std::cout << "[FRAME BUS] Publishing " << slot_count_ << " slots of " << slot_bytes_ << " bytes on " << name_ << std::endl;
+
+  return 0;
+}
+
+void FrameBusWriter::closeBus()
+{
+  if (header_ != NULL)
+    {
+      // readers still mapped on this segment find out instead of waiting forever
+      header_->closed.store(1, std::memory_order_release);
+      header_->futex_word.fetch_add(1, std::memory_order_release);
+      futexWake(&header_->futex_word);
+
+      munmap(header_, mapped_size_);
+      shm_unlink(name_.c_str());
+      header_ = NULL;
+      mapped_size_ = 0;
+    }
+}
+
+cv::Mat FrameBusWriter::acquireSlot( int rows, int cols, int type )
+{
+  size_t bytes = (size_t)rows * cols * CV_ELEM_SIZE(type);
+
+  if (header_ == NULL || bytes > slot_bytes_)
+    {
+      std::cout << "[FRAME BUS] Frame of " << bytes << " bytes does not fit in a slot" << std::endl;
+      return cv::Mat();
+    }
+
+  uint64_t sequence = header_->write_sequence.load(std::memory_order_relaxed) + 1;
+  uint64_t index = sequence % slot_count_;
+  FrameBusSlot& slot = busSlots(header_)[index];
+
+  // readers still holding this slot will see it go invalid from here on
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.rows = rows;
+  slot.cols = cols;
+  slot.type = type;
+  slot.step = (uint64_t)cols * CV_ELEM_SIZE(type);
+
+  pending_sequence_ = sequence;
+  pending_image_ = cv::Mat(rows, cols, type, busSlotData(header_, index));
+
+  return pending_image_;
+}
+
+int FrameBusWriter::commitSlot( double timestamp_us, uint32_t flags )
+{
+  if (pending_sequence_ == 0)
+    {
+      std::cout << "[FRAME BUS] No slot to commit" << std::endl;
+      return -1;
+    }
+
+  FrameBusSlot& slot = busSlots(header_)[pending_sequence_ % slot_count_];
+  slot.timestamp_us = timestamp_us;
+  slot.flags = flags;
+  slot.sequence.store(pending_sequence_, std::memory_order_release);
+
+  header_->write_sequence.store(pending_sequence_, std::memory_order_release);
+  header_->futex_word.fetch_add(1, std::memory_order_release);
+  futexWake(&header_->futex_word);
+
+  pending_sequence_ = 0;
+  pending_image_.release();
+
+  return 0;
+}
+
+int FrameBusWriter::publish( const cv::Mat& frame, double timestamp_us, uint32_t flags )
+{
+  cv::Mat slot = acquireSlot(frame.rows, frame.cols, frame.type());
+
+  if (slot.empty())
+    {
+      return -1;
+    }
+
+  frame.copyTo(slot);
+
+  return commitSlot(timestamp_us, flags);
+}
+
+FrameBusReader::FrameBusReader( std::string name )
+{
+  name_ = name;
+  header_ = NULL;
+  mapped_size_ = 0;
+  device_ = 0;
+  inode_ = 0;
+  last_sequence_ = 0;
+  skipped_ = 0;
+}
+
+FrameBusReader::~FrameBusReader()
+{
+  closeBus();
+}
+
+std::string FrameBusReader::getName()
+{
+  return name_;
+}
+
+uint64_t FrameBusReader::getSkipped()
+{
+  return skipped_;
+}
+
+int FrameBusReader::openBus()
+{
+  int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+
+  if (fd < 0)
+    {
+      perror("[FRAME BUS] ERROR: shm_open failed");
+      return -1;
+    }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(FrameBusHeader))
+    {
+      std::cout << "[FRAME BUS] Bus " << name_ << " is not ready" << std::endl;
+      close(fd);
+      return -1;
+    }
+
+  void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (mapped == MAP_FAILED)
+    {
+      perror("[FRAME BUS] ERROR: mmap failed");
+      return -1;
+    }
+
+  const FrameBusHeader* header = (const FrameBusHeader*)mapped;
+  size_t size = st.st_size;
+
+  if (memcmp(header->magic, BUS_MAGIC, sizeof(BUS_MAGIC)) != 0 || header->version != BUS_VERSION)
+    {
+      std::cout << "[FRAME BUS] Bus " << name_ << " is not ready" << std::endl;
+      munmap(mapped, size);
+      return -1;
+    }
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  // the ring has to fit in what was mapped before any slot is touched
+  if (header->slot_count == 0 ||
+      header->data_offset < sizeof(FrameBusHeader) + header->slot_count * sizeof(FrameBusSlot) ||
+      header->data_offset > size ||
+      header->slot_bytes > (size - header->data_offset) / header->slot_count)
+    {
+      std::cout << "[FRAME BUS] Bus " << name_ << " has a header that does not match its size" << std::endl;
+      munmap(mapped, size);
+      return -1;
+    }
+
+  header_ = header;
+  mapped_size_ = size;
+  device_ = st.st_dev;
+  inode_ = st.st_ino;
+  last_sequence_ = header_->write_sequence.load(std::memory_order_acquire);
+
+  return 0;
+}
+
+void FrameBusReader::closeBus()
+{
+  if (header_ != NULL)
+    {
+      munmap((void*)header_, mapped_size_);
+      header_ = NULL;
+      mapped_size_ = 0;
+    }
+}
+
+int FrameBusReader::waitFrame( FrameBusFrame& frame, int timeout_ms )
+{
+  if (header_ == NULL)
+    {
+      return -1;
+    }
+
+  struct timespec start, now;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  while (true)
+    {
+      // read the futex word first so a publish between the check and the wait wakes us
+      uint32_t futex_value = header_->futex_word.load(std::memory_order_acquire);
+      uint64_t sequence = header_->write_sequence.load(std::memory_order_acquire);
+
+      if (header_->closed.load(std::memory_order_acquire))
+	{
+	  std::cout << "[FRAME BUS] Bus " << name_ << " was closed by the writer, reopen it" << std::endl;
+	  return -1;
+	}
+
+      // a slot that is mid write, or lapped while it was read, falls through
+      // to the futex wait, the writer's commit wakes us again
+      if (sequence > last_sequence_)
+	{
+	  const FrameBusSlot& slot = busSlots(header_)[sequence % header_->slot_count];
+
+	  if (slot.sequence.load(std::memory_order_acquire) == sequence &&
+	      (uint64_t)slot.rows * slot.step <= header_->slot_bytes)
+	    {
+	      frame.image = cv::Mat(slot.rows, slot.cols, slot.type,
+				    busSlotData(header_, sequence % header_->slot_count), slot.step);
+	      frame.sequence = sequence;
+	      frame.timestamp_us = slot.timestamp_us;
+	      frame.flags = slot.flags;
+
+	      skipped_ += sequence - last_sequence_ - 1;
+	      last_sequence_ = sequence;
+
+	      // the writer may have lapped us while the header was read
+	      if (isValid(frame))
+		{
+		  return 0;
+		}
+	    }
+	}
+
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      int elapsed_ms = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+
+      if (elapsed_ms >= timeout_ms)
+	{
+	  // a writer that died without closing leaves us on a segment nobody publishes to
+	  if (isStale())
+	    {
+	      std::cout << "[FRAME BUS] Bus " << name_ << " was replaced by a new writer, reopen it" << std::endl;
+	    }
+	  return -1;
+	}
+
+      if (futexWait(&header_->futex_word, futex_value, timeout_ms - elapsed_ms) < 0 && errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT)
+	{
+	  perror("[FRAME BUS] ERROR: futex wait failed");
+	  return -1;
+	}
+    }
+}
+
+bool FrameBusReader::isStale()
+{
+  if (header_ == NULL)
+    {
+      return false;
+    }
+
+  int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    {
+      return true;
+    }
+
+  struct stat st;
+  bool stale = fstat(fd, &st) < 0 || st.st_dev != device_ || st.st_ino != inode_;
+  close(fd);
+
+  return stale;
+}
+
+bool FrameBusReader::isValid( const FrameBusFrame& frame )
+{
+  if (header_ == NULL)
+    {
+      return false;
+    }
+
+  const FrameBusSlot& slot = busSlots(header_)[frame.sequence % header_->slot_count];
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.sequence.load(std::memory_order_relaxed) == frame.sequence;
+}
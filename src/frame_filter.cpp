@@ -0,0 +1,249 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Redundant frame detection from block mean signatures
+ */
+
+#include "eeyore/frame_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// the block sums are the only part that touches every sampled pixel
+static uint64_t sumBytes( const uint8_t* p, int n )
+{
+  uint64_t sum = 0;
+  int i = 0;
+
+#if defined(__SSE2__)
+  // sad against zero adds 8 bytes into each 64 bit half
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16)
+    {
+      acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(p + i)), _mm_setzero_si128()));
+    }
+  uint64_t lanes[2];
+  _mm_storeu_si128((__m128i*)lanes, acc);
+  sum = lanes[0] + lanes[1];
+#elif defined(__ARM_NEON)
+  uint64x2_t acc = vdupq_n_u64(0);
+  for (; i + 16 <= n; i += 16)
+    {
+      acc = vpadalq_u32(acc, vpaddlq_u16(vpaddlq_u8(vld1q_u8(p + i))));
+    }
+  sum = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+#endif
+
+  for (; i < n; i++)
+    {
+      sum += p[i];
+    }
+  return sum;
+}
+
+static uint64_t sumWords( const uint16_t* p, int n )
+{
+  uint64_t sum = 0;
+  int i = 0;
+
+#if defined(__SSE2__)
+  // 32 bit lanes are plenty for one block row (up to ~250k words)
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 8 <= n; i += 8)
+    {
+      __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+      acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, _mm_setzero_si128()));
+      acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, _mm_setzero_si128()));
+    }
+  uint32_t lanes[4];
+  _mm_storeu_si128((__m128i*)lanes, acc);
+  sum = (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__ARM_NEON)
+  uint64x2_t acc = vdupq_n_u64(0);
+  for (; i + 8 <= n; i += 8)
+    {
+      acc = vpadalq_u32(acc, vpaddlq_u16(vld1q_u16(p + i)));
+    }
+  sum = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+#endif
+
+  for (; i < n; i++)
+    {
+      sum += p[i];
+    }
+  return sum;
+}
+
+FrameFilter::FrameFilter()
+{
+  threshold_ = 0.01;
+  grid_cols_ = 16;
+  grid_rows_ = 12;
+  max_interval_ = 30;
+  reset();
+}
+
+void FrameFilter::setThreshold( double threshold )
+{
+  threshold_ = threshold;
+}
+
+void FrameFilter::setGrid( int cols, int rows )
+{
+  grid_cols_ = std::max(cols, 1);
+  grid_rows_ = std::max(rows, 1);
+  keyframe_signature_.clear();
+}
+
+void FrameFilter::setMaxInterval( int frames )
+{
+  max_interval_ = frames;
+}
+
+double FrameFilter::getThreshold()
+{
+  return threshold_;
+}
+
+int FrameFilter::getGridCols()
+{
+  return grid_cols_;
+}
+
+int FrameFilter::getGridRows()
+{
+  return grid_rows_;
+}
+
+int FrameFilter::getMaxInterval()
+{
+  return max_interval_;
+}
+
+uint64_t FrameFilter::getFrameCount()
+{
+  return frames_;
+}
+
+uint64_t FrameFilter::getKeyframeCount()
+{
+  return keyframes_;
+}
+
+std::vector<float> FrameFilter::getSignature()
+{
+  return signature_;
+}
+
+void FrameFilter::reset()
+{
+  frames_ = 0;
+  keyframes_ = 0;
+  since_keyframe_ = 0;
+  signature_.clear();
+  keyframe_signature_.clear();
+}
+
+void FrameFilter::computeSignature( const cv::Mat& frame, std::vector<float>& signature )
+{
+  signature.clear();
+
+  if (frame.empty() || (frame.depth() != CV_8U && frame.depth() != CV_16U))
+    {
+      return;
+    }
+
+  int rows = frame.rows;
+  int cols = frame.cols;
+  int cn = frame.channels();
+  double full_scale = frame.depth() == CV_8U ? 255.0 : 65535.0;
+  int grid_rows = std::min(grid_rows_, rows);
+  int grid_cols = std::min(grid_cols_, cols);
+
+  signature.assign(grid_rows * grid_cols, 0.0f);
+  block_sums_.resize(grid_cols);
+
+  for (int gr = 0; gr < grid_rows; gr++)
+    {
+      int r0 = gr * rows / grid_rows;
+      int r1 = (gr + 1) * rows / grid_rows;
+      // a block mean doesn't need every row, 16 evenly spaced ones will do
+      int step = std::max((r1 - r0) / 16, 1);
+      int sampled = 0;
+
+      std::fill(block_sums_.begin(), block_sums_.end(), 0);
+
+      for (int r = r0; r < r1; r += step)
+	{
+	  for (int gc = 0; gc < grid_cols; gc++)
+	    {
+	      // channels are summed together, so color frames get a luma-ish mean
+	      int c0 = gc * cols / grid_cols * cn;
+	      int c1 = (gc + 1) * cols / grid_cols * cn;
+
+	      if (frame.depth() == CV_8U)
+		{
+		  block_sums_[gc] += sumBytes(frame.ptr<uint8_t>(r) + c0, c1 - c0);
+		}
+	      else
+		{
+		  block_sums_[gc] += sumWords(frame.ptr<uint16_t>(r) + c0, c1 - c0);
+		}
+	    }
+	  sampled++;
+	}
+
+      for (int gc = 0; gc < grid_cols; gc++)
+	{
+	  int width = ((gc + 1) * cols / grid_cols - gc * cols / grid_cols) * cn;
+	  signature[gr * grid_cols + gc] = block_sums_[gc] / ((double)sampled * width * full_scale);
+	}
+    }
+}
+
+FilterResult FrameFilter::update( const cv::Mat& frame )
+{
+  FilterResult result;
+
+  computeSignature(frame, signature_);
+  frames_++;
+
+  // anything that can't be compared is kept, it is never safe to drop it
+  double difference = 1.0;
+  if (!signature_.empty() && signature_.size() == keyframe_signature_.size())
+    {
+      // the block that moved the most decides, a mean over the grid would
+      // divide a hot spot or a small moving object away
+      difference = 0.0;
+      for (size_t i = 0; i < signature_.size(); i++)
+	{
+	  difference = std::max(difference, (double)std::fabs(signature_[i] - keyframe_signature_[i]));
+	}
+    }
+
+  // compared against the last keyframe rather than the last frame, so a
+  // slow drift still adds up to a new keyframe
+  bool keyframe = difference >= threshold_ || (max_interval_ > 0 && since_keyframe_ + 1 >= (uint64_t)max_interval_);
+
+  if (keyframe)
+    {
+      keyframe_signature_ = signature_;
+      keyframes_++;
+      since_keyframe_ = 0;
+    }
+  else
+    {
+      since_keyframe_++;
+    }
+
+  result.keyframe = keyframe;
+  result.difference = difference;
+  result.frames_since_keyframe = since_keyframe_;
+
+  return result;
+}
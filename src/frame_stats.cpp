@@ -0,0 +1,126 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Frame drop and jitter accounting
+ */
+
+#include "eeyore/frame_stats.hpp"
+
+#include <cmath>
+#include <iostream>
+
+FrameStats::FrameStats()
+{
+  expected_period_us_ = 0.0;
+  late_factor_ = 1.5;
+  reset();
+}
+
+void FrameStats::setExpectedPeriod( double period_us )
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  expected_period_us_ = period_us;
+}
+
+void FrameStats::setLateFactor( double factor )
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  late_factor_ = factor;
+}
+
+double FrameStats::getExpectedPeriod()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return expected_period_us_;
+}
+
+double FrameStats::getLateFactor()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return late_factor_;
+}
+
+FrameStatsSnapshot FrameStats::getSnapshot()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  FrameStatsSnapshot snapshot;
+  snapshot.delivered = delivered_;
+  snapshot.dropped = dropped_;
+  snapshot.incomplete = incomplete_;
+  snapshot.late = late_;
+  snapshot.mean_interval_us = interval_mean_;
+  snapshot.jitter_us = intervals_ > 1 ? std::sqrt(interval_m2_ / (intervals_ - 1)) : 0.0;
+  snapshot.max_interval_us = interval_max_;
+
+  return snapshot;
+}
+
+void FrameStats::update( uint64_t sequence, double timestamp_us, bool incomplete )
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  delivered_++;
+  if (incomplete)
+    {
+      incomplete_++;
+    }
+
+  // a sequence that goes backwards means the stream was restarted, resync on it
+  if (have_last_ && sequence > last_sequence_)
+    {
+      uint64_t gap = sequence - last_sequence_;
+      dropped_ += gap - 1;
+
+      // spread the interval over the missing frames so drops do not show up as jitter
+      double interval = (timestamp_us - last_timestamp_us_) / gap;
+
+      intervals_++;
+      double delta = interval - interval_mean_;
+      interval_mean_ += delta / intervals_;
+      interval_m2_ += delta * (interval - interval_mean_);
+
+      if (interval > interval_max_)
+	{
+	  interval_max_ = interval;
+	}
+
+      double period = expected_period_us_ > 0.0 ? expected_period_us_ : interval_mean_;
+      if (gap == 1 && intervals_ > 1 && interval > late_factor_ * period)
+	{
+	  late_++;
+	}
+    }
+
+  have_last_ = true;
+  last_sequence_ = sequence;
+  last_timestamp_us_ = timestamp_us;
+}
+
+void FrameStats::reset()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  have_last_ = false;
+  last_sequence_ = 0;
+  last_timestamp_us_ = 0.0;
+
+  delivered_ = 0;
+  dropped_ = 0;
+  incomplete_ = 0;
+  late_ = 0;
+
+  intervals_ = 0;
+  interval_mean_ = 0.0;
+  interval_m2_ = 0.0;
+  interval_max_ = 0.0;
+}
+
+void FrameStats::printStats( std::string tag )
+{
+  FrameStatsSnapshot s = getSnapshot();
+
+  std::cout << tag << " Frames delivered: " << s.delivered << ", dropped: " << s.dropped
+	    << ", incomplete: " << s.incomplete << ", late: " << s.late << std::endl;
+  std::cout << tag << " Frame interval: " << s.mean_interval_us << " us, jitter: " << s.jitter_us
+	    << " us, max: " << s.max_interval_us << " us" << std::endl;
+}
@@ -0,0 +1,363 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Software non-uniformity and bad pixel correction for raw Y16 data
+ */
+
+#include "eeyore/nuc.hpp"
+
+#include <algorithm>
+
+NucCorrector::NucCorrector()
+{
+  scene_update_ = false;
+  update_rate_ = 0.01;
+  update_interval_ = 2;
+  motion_threshold_ = 2.0;
+  frame_count_ = 0;
+  tables_loaded_ = false;
+}
+
+void NucCorrector::setTables( cv::Mat gain, cv::Mat offset )
+{
+  if (gain.empty() || gain.size() != offset.size() || gain.channels() != 1 || offset.channels() != 1)
+    {
+      std::cout << "[NUC] Gain and offset tables must be single channel and the same size" << std::endl;
+      return;
+    }
+
+  gain.convertTo(gain_, CV_32F);
+  offset.convertTo(offset_, CV_32F);
+  base_offset_ = offset_.clone();
+  previous_.release();
+  tables_loaded_ = true;
+
+  buildReplacementMap();
+}
+
+void NucCorrector::setBadPixels( const std::vector<cv::Point>& pixels )
+{
+  bad_pixels_ = pixels;
+  buildReplacementMap();
+}
+
+void NucCorrector::setSceneUpdate( bool enable )
+{
+  scene_update_ = enable;
+  previous_.release();
+}
+
+void NucCorrector::setUpdateRate( double rate )
+{
+  update_rate_ = rate;
+}
+
+void NucCorrector::setUpdateInterval( int frames )
+{
+  update_interval_ = std::max(frames, 1);
+}
+
+void NucCorrector::setMotionThreshold( double counts )
+{
+  motion_threshold_ = counts;
+}
+
+cv::Mat NucCorrector::getGain()
+{
+  return gain_;
+}
+
+cv::Mat NucCorrector::getOffset()
+{
+  return offset_;
+}
+
+std::vector<cv::Point> NucCorrector::getBadPixels()
+{
+  return bad_pixels_;
+}
+
+bool NucCorrector::getSceneUpdate()
+{
+  return scene_update_;
+}
+
+double NucCorrector::getUpdateRate()
+{
+  return update_rate_;
+}
+
+int NucCorrector::getUpdateInterval()
+{
+  return update_interval_;
+}
+
+double NucCorrector::getMotionThreshold()
+{
+  return motion_threshold_;
+}
+
+int NucCorrector::loadTables( std::string file_path )
+{
+  cv::FileStorage fs(file_path, cv::FileStorage::READ);
+
+  if (!fs.isOpened())
+    {
+      std::cout << "[NUC] Could not open " << file_path << std::endl;
+      return -1;
+    }
+
+  cv::Mat gain, offset, bad;
+  fs["gain"] >> gain;
+  fs["offset"] >> offset;
+  fs["bad_pixels"] >> bad;
+
+  if (gain.empty() || offset.empty())
+    {
+      std::cout << "[NUC] " << file_path << " is missing the gain or offset table" << std::endl;
+      return -1;
+    }
+
+  // bad pixels are stored as an N x 2 list of x, y
+  std::vector<cv::Point> pixels;
+  for (int i = 0; i < bad.rows; i++)
+    {
+      pixels.push_back(cv::Point(bad.at<int>(i, 0), bad.at<int>(i, 1)));
+    }
+
+  bad_pixels_ = pixels;
+  setTables(gain, offset);
+
+  std::cout << "[NUC] Loaded " << gain_.cols << "x" << gain_.rows << " tables with " << fixes_.size() << " bad pixels" << std::endl;
+
+  return 0;
+}
+
+int NucCorrector::saveTables( std::string file_path )
+{
+  cv::FileStorage fs(file_path, cv::FileStorage::WRITE);
+
+  if (!fs.isOpened())
+    {
+      std::cout << "[NUC] Could not open " << file_path << std::endl;
+      return -1;
+    }
+
+  cv::Mat bad((int)bad_pixels_.size(), 2, CV_32S);
+  for (size_t i = 0; i < bad_pixels_.size(); i++)
+    {
+      bad.at<int>(i, 0) = bad_pixels_[i].x;
+      bad.at<int>(i, 1) = bad_pixels_[i].y;
+    }
+
+  // the scene learnt offsets only hold until the next FFC, so the base ones are saved
+  fs << "gain" << gain_;
+  fs << "offset" << base_offset_;
+  fs << "bad_pixels" << bad;
+  fs.release();
+
+  return 0;
+}
+
+int NucCorrector::findBadPixels( const cv::Mat& flat_16, double threshold )
+{
+  if (flat_16.type() != CV_16UC1)
+    {
+      std::cout << "[NUC] Bad pixel search needs a raw Y16 flat field" << std::endl;
+      return -1;
+    }
+
+  // same rule as apply, loaded tables are never swapped for unity ones
+  if (gain_.rows != flat_16.rows || gain_.cols != flat_16.cols)
+    {
+      if (tables_loaded_)
+	{
+	  std::cout << "[NUC] Flat field is " << flat_16.cols << "x" << flat_16.rows << " but the loaded tables are "
+		    << gain_.cols << "x" << gain_.rows << std::endl;
+	  return -1;
+	}
+      allocate(flat_16.rows, flat_16.cols);
+    }
+
+  // the median only runs here, at runtime the result is just an index list
+  cv::Mat median, flat, local, diff;
+  cv::medianBlur(flat_16, median, 3);
+  flat_16.convertTo(flat, CV_32F);
+  median.convertTo(local, CV_32F);
+  cv::absdiff(flat, local, diff);
+
+  cv::Scalar mean, stddev;
+  cv::meanStdDev(diff, mean, stddev);
+  double limit = mean[0] + threshold * stddev[0];
+
+  std::vector<cv::Point> pixels;
+  for (int i = 0; i < diff.rows; i++)
+    {
+      const float* row = diff.ptr<float>(i);
+      for (int j = 0; j < diff.cols; j++)
+	{
+	  if (row[j] > limit)
+	    {
+	      pixels.push_back(cv::Point(j, i));
+	    }
+	}
+    }
+
+  setBadPixels(pixels);
+  std::cout << "[NUC] Found " << pixels.size() << " bad pixels" << std::endl;
+
+  return pixels.size();
+}
+
+int NucCorrector::apply( const cv::Mat& input_16, cv::Mat& output_16 )
+{
+  // unity tables stand in until real ones are loaded and follow the frame
+  // size, loaded tables are never thrown away for a frame of another size
+  if (gain_.rows != input_16.rows || gain_.cols != input_16.cols)
+    {
+      if (tables_loaded_)
+	{
+	  return -1;
+	}
+      allocate(input_16.rows, input_16.cols);
+    }
+
+  PixelPipeline< OffsetGainStage > nuc(OffsetGainStage(gain_, offset_));
+  nuc.run(input_16, output_16);
+
+  // the replacement map is in flat indices, so the output can't be a view
+  CV_Assert(output_16.isContinuous());
+  uint16_t* data = output_16.ptr<uint16_t>();
+  for (size_t i = 0; i < fixes_.size(); i++)
+    {
+      const BadPixelFix& fix = fixes_[i];
+      data[fix.index] = (data[fix.source_a] + data[fix.source_b] + 1) >> 1;
+    }
+
+  frame_count_++;
+  if (scene_update_ && frame_count_ % update_interval_ == 0)
+    {
+      updateScene(output_16);
+    }
+  return 0;
+}
+
+void NucCorrector::resetScene()
+{
+  if (!base_offset_.empty())
+    {
+      base_offset_.copyTo(offset_);
+    }
+  previous_.release();
+}
+
+void NucCorrector::allocate( int rows, int cols )
+{
+  // unit gain and zero offset until real tables are loaded
+  gain_ = cv::Mat(rows, cols, CV_32FC1, cv::Scalar(1.0));
+  offset_ = cv::Mat(rows, cols, CV_32FC1, cv::Scalar(0.0));
+  base_offset_ = offset_.clone();
+  previous_.release();
+
+  buildReplacementMap();
+}
+
+void NucCorrector::buildReplacementMap()
+{
+  fixes_.clear();
+
+  if (gain_.empty())
+    {
+      return;
+    }
+
+  int rows = gain_.rows;
+  int cols = gain_.cols;
+
+  cv::Mat bad = cv::Mat::zeros(rows, cols, CV_8UC1);
+  for (size_t i = 0; i < bad_pixels_.size(); i++)
+    {
+      const cv::Point& p = bad_pixels_[i];
+      if (p.x >= 0 && p.x < cols && p.y >= 0 && p.y < rows)
+	{
+	  bad.at<uint8_t>(p.y, p.x) = 1;
+	}
+    }
+
+  for (size_t i = 0; i < bad_pixels_.size(); i++)
+    {
+      const cv::Point& p = bad_pixels_[i];
+      if (p.x < 0 || p.x >= cols || p.y < 0 || p.y >= rows)
+	{
+	  continue;
+	}
+
+      // nearest good pixel either side in the row, then in the column for
+      // clusters that run along a row
+      int a = -1;
+      int b = -1;
+      for (int d = 1; d <= 4 && (a < 0 || b < 0); d++)
+	{
+	  if (a < 0 && p.x - d >= 0 && !bad.at<uint8_t>(p.y, p.x - d))
+	    {
+	      a = p.y * cols + p.x - d;
+	    }
+	  if (b < 0 && p.x + d < cols && !bad.at<uint8_t>(p.y, p.x + d))
+	    {
+	      b = p.y * cols + p.x + d;
+	    }
+	}
+      for (int d = 1; d <= 4 && (a < 0 || b < 0); d++)
+	{
+	  if (a < 0 && p.y - d >= 0 && !bad.at<uint8_t>(p.y - d, p.x))
+	    {
+	      a = (p.y - d) * cols + p.x;
+	    }
+	  if (b < 0 && p.y + d < rows && !bad.at<uint8_t>(p.y + d, p.x))
+	    {
+	      b = (p.y + d) * cols + p.x;
+	    }
+	}
+
+      if (a < 0 && b < 0)
+	{
+	  continue;
+	}
+
+      BadPixelFix fix;
+      fix.index = p.y * cols + p.x;
+      fix.source_a = a < 0 ? b : a;
+      fix.source_b = b < 0 ? a : b;
+      fixes_.push_back(fix);
+    }
+
+  // walk the frame in memory order when applying
+  std::sort(fixes_.begin(), fixes_.end(), []( const BadPixelFix& l, const BadPixelFix& r ) { return l.index < r.index; });
+}
+
+void NucCorrector::updateScene( const cv::Mat& corrected_16 )
+{
+  cv::Mat frame;
+  corrected_16.convertTo(frame, CV_32F);
+
+  if (previous_.empty())
+    {
+      previous_ = frame;
+      return;
+    }
+
+  // a still scene would get learnt into the offsets, so only update while it moves
+  cv::Mat diff;
+  cv::absdiff(frame, previous_, diff);
+  previous_ = frame;
+
+  if (cv::mean(diff)[0] < motion_threshold_)
+    {
+      return;
+    }
+
+  // with the scene moving, what the local mean doesn't explain is fixed pattern
+  cv::Mat smooth;
+  cv::blur(frame, smooth, cv::Size(5, 5));
+  cv::Mat residual = frame - smooth;
+  cv::addWeighted(offset_, 1.0, residual, -update_rate_, 0.0, offset_);
+}
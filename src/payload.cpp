@@ -0,0 +1,247 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Parallel startup of the EO/IR payload
+ */
+
+#include "eeyore/payload.hpp"
+
+Payload::Payload( Boson& boson, ElectroOpticalCam& eo ) : boson_(boson), eo_(eo)
+{
+  first_frame_timeout_ms_ = 10000;
+  lock_memory_ = false;
+  metrics_.eo_init_ms = -1;
+  metrics_.eo_first_frame_ms = -1;
+  metrics_.ir_stream_ms = -1;
+  metrics_.ir_fcc_ms = -1;
+  metrics_.ir_first_frame_ms = -1;
+  metrics_.total_ms = -1;
+  capturing_ = false;
+}
+
+Payload::~Payload()
+{
+  stopCapture();
+}
+
+void Payload::setFirstFrameTimeout( int timeout_ms )
+{
+  first_frame_timeout_ms_ = timeout_ms;
+}
+
+void Payload::setIrThreadConfig( ThreadConfig config )
+{
+  ir_thread_config_ = config;
+}
+
+void Payload::setEoThreadConfig( ThreadConfig config )
+{
+  eo_thread_config_ = config;
+}
+
+void Payload::setLockMemory( bool enable )
+{
+  lock_memory_ = enable;
+}
+
+int Payload::getFirstFrameTimeout()
+{
+  return first_frame_timeout_ms_;
+}
+
+StartupMetrics Payload::getStartupMetrics()
+{
+  return metrics_;
+}
+
+ThreadConfig Payload::getIrThreadConfig()
+{
+  return ir_thread_config_;
+}
+
+ThreadConfig Payload::getEoThreadConfig()
+{
+  return eo_thread_config_;
+}
+
+bool Payload::getLockMemory()
+{
+  return lock_memory_;
+}
+
+double Payload::elapsedMs()
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time_).count();
+}
+
+int Payload::start()
+{
+  start_time_ = std::chrono::steady_clock::now();
+
+  // lock before the cameras allocate their buffers so those are covered too
+  if (lock_memory_)
+    {
+      lockMemory();
+    }
+
+  // the boson spends most of its startup waiting on the shutter, so each
+  // camera gets its own thread. These threads end with startup, the thread
+  // configs only carry over to capture through startCapture
+  std::future<int> ir_result = std::async(std::launch::async, &Payload::startIr, this);
+  std::future<int> eo_future = std::async(std::launch::async, &Payload::startEo, this);
+  int eo_result = eo_future.get();
+  int result = ir_result.get();
+
+  metrics_.total_ms = elapsedMs();
+  printStartupMetrics();
+
+  if (eo_result < 0 || result < 0)
+    {
+      return -1;
+    }
+  return 0;
+}
+
+std::future<int> Payload::startAsync()
+{
+  return std::async(std::launch::async, &Payload::start, this);
+}
+
+int Payload::startIr()
+{
+  if (applyThreadConfig(ir_thread_config_) < 0)
+    {
+      std::cout << "[PAYLOAD] Running IR startup without " << describeThreadConfig(ir_thread_config_) << std::endl;
+    }
+
+  // kick off the FFC and set up the V4L2 stream while the shutter settles
+  if (boson_.beginFcc() < 0)
+    {
+      return -1;
+    }
+
+  int result = boson_.openSensor();
+  metrics_.ir_stream_ms = elapsedMs();
+
+  boson_.endFcc();
+  metrics_.ir_fcc_ms = elapsedMs();
+
+  if (result < 0)
+    {
+      return -1;
+    }
+
+  while (elapsedMs() < first_frame_timeout_ms_)
+    {
+      if (!boson_.getFrame().empty())
+	{
+	  metrics_.ir_first_frame_ms = elapsedMs();
+	  return 0;
+	}
+    }
+
+  std::cout << "[PAYLOAD] Timed out waiting for the first IR frame" << std::endl;
+  return -1;
+}
+
+int Payload::startEo()
+{
+  if (applyThreadConfig(eo_thread_config_) < 0)
+    {
+      std::cout << "[PAYLOAD] Running EO startup without " << describeThreadConfig(eo_thread_config_) << std::endl;
+    }
+
+  if (!eo_.isInitialized() && eo_.initCam() < 0)
+    {
+      std::cout << "[PAYLOAD] Failed to find the EO camera" << std::endl;
+      return -1;
+    }
+  metrics_.eo_init_ms = elapsedMs();
+
+  if (eo_.configureTrigger() < 0 || eo_.setupCamera() < 0 || eo_.startCamera() < 0)
+    {
+      std::cout << "[PAYLOAD] Failed to start the EO camera" << std::endl;
+      return -1;
+    }
+
+  // getFrame already waits up to a second per call for a trigger
+  while (elapsedMs() < first_frame_timeout_ms_)
+    {
+      if (!eo_.getFrame().empty())
+	{
+	  metrics_.eo_first_frame_ms = elapsedMs();
+	  return 0;
+	}
+    }
+
+  std::cout << "[PAYLOAD] Timed out waiting for the first EO frame" << std::endl;
+  return -1;
+}
+
+int Payload::startCapture( std::function<void(const cv::Mat&)> ir_callback, std::function<void(const cv::Mat&)> eo_callback )
+{
+  if (capturing_)
+    {
+      std::cout << "[PAYLOAD] Capture is already running" << std::endl;
+      return -1;
+    }
+
+  // each camera is read on a thread of its own that keeps its config for
+  // as long as it runs, a camera without a callback is left to the caller
+  capturing_ = true;
+  if (ir_callback)
+    {
+      ir_thread_ = std::thread(&Payload::captureLoop, this, ir_thread_config_, [this]() { return boson_.getFrame(); }, ir_callback);
+    }
+  if (eo_callback)
+    {
+      eo_thread_ = std::thread(&Payload::captureLoop, this, eo_thread_config_, [this]() { return eo_.getFrame(); }, eo_callback);
+    }
+
+  std::cout << "[PAYLOAD] Capturing IR with " << describeThreadConfig(ir_thread_config_)
+	    << ", EO with " << describeThreadConfig(eo_thread_config_) << std::endl;
+
+  return 0;
+}
+
+void Payload::stopCapture()
+{
+  // getFrame waits at most about a second, so the loops see the flag soon
+  capturing_ = false;
+
+  if (ir_thread_.joinable())
+    {
+      ir_thread_.join();
+    }
+  if (eo_thread_.joinable())
+    {
+      eo_thread_.join();
+    }
+}
+
+void Payload::captureLoop( ThreadConfig config, std::function<cv::Mat()> grab, std::function<void(const cv::Mat&)> callback )
+{
+  if (applyThreadConfig(config) < 0)
+    {
+      std::cout << "[PAYLOAD] Capturing without " << describeThreadConfig(config) << std::endl;
+    }
+
+  while (capturing_)
+    {
+      cv::Mat frame = grab();
+      if (frame.empty())
+	{
+	  // a closed or reconnecting camera returns straight away, don't spin on it
+	  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	  continue;
+	}
+      callback(frame);
+    }
+}
+
+void Payload::printStartupMetrics()
+{
+  std::cout << "[PAYLOAD] EO init: " << metrics_.eo_init_ms << " ms, first frame: " << metrics_.eo_first_frame_ms << " ms" << std::endl;
+  std::cout << "[PAYLOAD] IR stream: " << metrics_.ir_stream_ms << " ms, FFC: " << metrics_.ir_fcc_ms
+	    << " ms, first frame: " << metrics_.ir_first_frame_ms << " ms" << std::endl;
+  std::cout << "[PAYLOAD] Time to first frame: " << metrics_.total_ms << " ms" << std::endl;
+}
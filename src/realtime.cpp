@@ -0,0 +1,118 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Real time scheduling helpers for the threads the library runs
+ */
+
+#include "eeyore/realtime.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+int applyThreadConfig( const ThreadConfig& config )
+{
+  int result = 0;
+
+  if (!config.cpus.empty())
+    {
+      // CPU_SET past the set quietly does nothing, and an offline cpu
+      // would leave the thread pinned to less than was asked for
+      long online = sysconf(_SC_NPROCESSORS_ONLN);
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (size_t i = 0; i < config.cpus.size(); i++)
+	{
+	  int cpu = config.cpus[i];
+	  if (cpu < 0 || cpu >= CPU_SETSIZE || cpu >= online)
+	    {
+	      std::cout << "[REALTIME] CPU " << cpu << " is out of range, " << online << " cpus are online" << std::endl;
+	      return -1;
+	    }
+	  CPU_SET(cpu, &set);
+	}
+
+      int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+      if (err != 0)
+	{
+	  std::cout << "[REALTIME] Failed to set CPU affinity: " << strerror(err) << std::endl;
+	  result = -1;
+	}
+    }
+
+  if (config.priority > 0)
+    {
+      struct sched_param param;
+      param.sched_priority = std::min(std::max(config.priority, sched_get_priority_min(SCHED_FIFO)), sched_get_priority_max(SCHED_FIFO));
+
+      int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+      if (err != 0)
+	{
+	  std::cout << "[REALTIME] Failed to set SCHED_FIFO priority " << param.sched_priority << ": " << strerror(err) << std::endl;
+	  result = -1;
+	}
+    }
+  else if (config.nice != 0)
+    {
+      // linux keeps a nice value per thread, addressed by its tid
+      if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), config.nice) < 0)
+	{
+	  perror("[REALTIME] ERROR: setpriority failed");
+	  result = -1;
+	}
+    }
+
+  return result;
+}
+
+int lockMemory()
+{
+  // page faults on the frame path are as bad as being preempted
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+    {
+      perror("[REALTIME] ERROR: mlockall failed");
+      return -1;
+    }
+  return 0;
+}
+
+void unlockMemory()
+{
+  munlockall();
+}
+
+std::string describeThreadConfig( const ThreadConfig& config )
+{
+  std::stringstream ss;
+
+  if (config.priority > 0)
+    {
+      ss << "SCHED_FIFO " << config.priority;
+    }
+  else if (config.nice != 0)
+    {
+      ss << "SCHED_OTHER nice " << config.nice;
+    }
+  else
+    {
+      ss << "SCHED_OTHER";
+    }
+
+  if (!config.cpus.empty())
+    {
+      ss << " on cpus";
+      for (size_t i = 0; i < config.cpus.size(); i++)
+	{
+	  ss << (i == 0 ? " " : ",") << config.cpus[i];
+	}
+    }
+
+  return ss.str();
+}
@@ -0,0 +1,401 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: EO/IR registration and the fused thermal overlay
+ */
+
+#include "eeyore/registration.hpp"
+#include "eeyore/pixel_pipeline.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+EoIrRegistration::EoIrRegistration()
+{
+  eo_width_ = 4096;
+  eo_height_ = 3000;
+  ir_width_ = 640;
+  ir_height_ = 512;
+  out_width_ = 1024;
+  out_height_ = 750;
+
+  rotation_ = cv::Mat::eye(3, 3, CV_64F);
+  translation_ = cv::Mat::zeros(3, 1, CV_64F);
+  scene_distance_ = 100.0;
+
+  eo_rectified_ = false;
+  ir_rectified_ = false;
+  maps_valid_ = false;
+
+  setAlpha(0.5);
+  eo_offsets_cols_ = 0;
+}
+
+void EoIrRegistration::setEoSize( int width, int height )
+{
+  eo_width_ = width;
+  eo_height_ = height;
+  maps_valid_ = false;
+}
+
+void EoIrRegistration::setIrSize( int width, int height )
+{
+  ir_width_ = width;
+  ir_height_ = height;
+  maps_valid_ = false;
+}
+
+void EoIrRegistration::setOutputSize( int width, int height )
+{
+  out_width_ = width;
+  out_height_ = height;
+  eo_offsets_cols_ = 0;
+  maps_valid_ = false;
+}
+
+void EoIrRegistration::setExtrinsics( cv::Mat rotation, cv::Mat translation )
+{
+  // a rotation vector is fine too
+  if (rotation.total() == 3)
+    {
+      cv::Mat rvec;
+      rotation.convertTo(rvec, CV_64F);
+      cv::Rodrigues(rvec, rotation_);
+    }
+  else
+    {
+      rotation.convertTo(rotation_, CV_64F);
+    }
+  translation.reshape(1, 3).convertTo(translation_, CV_64F);
+  maps_valid_ = false;
+}
+
+void EoIrRegistration::setSceneDistance( double meters )
+{
+  scene_distance_ = meters;
+  maps_valid_ = false;
+}
+
+void EoIrRegistration::setEoRectified( bool rectified )
+{
+  eo_rectified_ = rectified;
+  maps_valid_ = false;
+}
+
+void EoIrRegistration::setIrRectified( bool rectified )
+{
+  ir_rectified_ = rectified;
+  maps_valid_ = false;
+}
+
+void EoIrRegistration::setAlpha( double alpha )
+{
+  // 7 bit weight, so the blend fits in 16 bit lanes
+  alpha_ = std::max(0, std::min(128, (int)(alpha * 128.0 + 0.5)));
+}
+
+void EoIrRegistration::setPalette( int colormap )
+{
+  palette_.setPalette(colormap);
+}
+
+int EoIrRegistration::getOutputWidth()
+{
+  return out_width_;
+}
+
+int EoIrRegistration::getOutputHeight()
+{
+  return out_height_;
+}
+
+double EoIrRegistration::getSceneDistance()
+{
+  return scene_distance_;
+}
+
+double EoIrRegistration::getAlpha()
+{
+  return alpha_ / 128.0;
+}
+
+cv::Mat EoIrRegistration::getMap1()
+{
+  return map1_;
+}
+
+cv::Mat EoIrRegistration::getMap2()
+{
+  return map2_;
+}
+
+int EoIrRegistration::loadCalibration( std::string eo_yaml, std::string ir_yaml, std::string extrinsics_yaml )
+{
+  cv::Mat eo_K = CalibrationStore::readYaml(eo_yaml, "K", "[REGISTRATION]");
+  cv::Mat eo_D = CalibrationStore::readYaml(eo_yaml, "D", "[REGISTRATION]");
+  cv::Mat ir_K = CalibrationStore::readYaml(ir_yaml, "K", "[REGISTRATION]");
+  cv::Mat ir_D = CalibrationStore::readYaml(ir_yaml, "D", "[REGISTRATION]");
+
+  if (eo_K.empty() || eo_D.empty() || ir_K.empty() || ir_D.empty())
+    {
+      return -1;
+    }
+
+  eo_K.convertTo(eo_intrinsic_coeffs_, CV_64F);
+  eo_D.reshape(1, 1).convertTo(eo_distance_coeffs_, CV_64F);
+  ir_K.convertTo(ir_intrinsic_coeffs_, CV_64F);
+  ir_D.reshape(1, 1).convertTo(ir_distance_coeffs_, CV_64F);
+
+  // without extrinsics the cameras are taken as co-located and aligned
+  if (!extrinsics_yaml.empty())
+    {
+      cv::Mat R = CalibrationStore::readYaml(extrinsics_yaml, "R", "[REGISTRATION]");
+      cv::Mat T = CalibrationStore::readYaml(extrinsics_yaml, "T", "[REGISTRATION]");
+
+      if (R.empty() || T.empty())
+	{
+	  return -1;
+	}
+      setExtrinsics(R, T);
+    }
+
+  maps_valid_ = false;
+
+  return 0;
+}
+
+int EoIrRegistration::buildMaps()
+{
+  if (eo_intrinsic_coeffs_.empty() || ir_intrinsic_coeffs_.empty())
+    {
+      std::cout << "[REGISTRATION] Load both calibrations before building the maps" << std::endl;
+      return -1;
+    }
+
+  cv::Mat no_distortion;
+  cv::Mat eo_D = eo_rectified_ ? no_distortion : eo_distance_coeffs_;
+  cv::Mat ir_D = ir_rectified_ ? no_distortion : ir_distance_coeffs_;
+  size_t count = (size_t)out_width_ * out_height_;
+
+  // centre of each output pixel, in the EO image the calibration was done on
+  std::vector<cv::Point2f> eo_points;
+  eo_points.reserve(count);
+  double sx = (double)eo_width_ / out_width_;
+  double sy = (double)eo_height_ / out_height_;
+  for (int v = 0; v < out_height_; v++)
+    {
+      for (int u = 0; u < out_width_; u++)
+	{
+	  eo_points.push_back(cv::Point2f((float)((u + 0.5) * sx - 0.5), (float)((v + 0.5) * sy - 0.5)));
+	}
+    }
+
+  cv::Mat eo_rays;
+  cv::undistortPoints(eo_points, eo_rays, eo_intrinsic_coeffs_, eo_D);
+
+  // rays past the corners of the IR image can fold back into it through the
+  // distortion polynomial, so anything wider than the corners is dropped
+  std::vector<cv::Point2f> corners;
+  corners.push_back(cv::Point2f(0.0f, 0.0f));
+  corners.push_back(cv::Point2f(ir_width_ - 1.0f, 0.0f));
+  corners.push_back(cv::Point2f(0.0f, ir_height_ - 1.0f));
+  corners.push_back(cv::Point2f(ir_width_ - 1.0f, ir_height_ - 1.0f));
+
+  cv::Mat corner_rays;
+  cv::undistortPoints(corners, corner_rays, ir_intrinsic_coeffs_, ir_D);
+  double max_r2 = 0.0;
+  for (int i = 0; i < 4; i++)
+    {
+      const cv::Point2f& c = corner_rays.ptr<cv::Point2f>(0)[i];
+      max_r2 = std::max(max_r2, (double)(c.x * c.x + c.y * c.y));
+    }
+
+  // onto the scene plane, across into the IR camera frame, then back out as a ray
+  const double* R = rotation_.ptr<double>(0);
+  const double* T = translation_.ptr<double>(0);
+  const double d = scene_distance_;
+  std::vector<cv::Point3f> ir_rays;
+  std::vector<bool> visible(count, false);
+  ir_rays.reserve(count);
+
+  for (size_t i = 0; i < count; i++)
+    {
+      const cv::Point2f& r = eo_rays.ptr<cv::Point2f>(0)[i];
+      double X = R[0] * r.x * d + R[1] * r.y * d + R[2] * d + T[0];
+      double Y = R[3] * r.x * d + R[4] * r.y * d + R[5] * d + T[1];
+      double Z = R[6] * r.x * d + R[7] * r.y * d + R[8] * d + T[2];
+
+      double x = Z > 0.0 ? X / Z : 0.0;
+      double y = Z > 0.0 ? Y / Z : 0.0;
+      visible[i] = Z > 0.0 && x * x + y * y <= 1.05 * max_r2;
+      ir_rays.push_back(cv::Point3f((float)x, (float)y, 1.0f));
+    }
+
+  cv::Mat ir_pixels;
+  cv::Mat zero = cv::Mat::zeros(3, 1, CV_64F);
+  cv::projectPoints(ir_rays, zero, zero, ir_intrinsic_coeffs_, ir_D, ir_pixels);
+
+  // hidden pixels land far outside the IR image, which overlay skips
+  cv::Mat map(out_height_, out_width_, CV_32FC2);
+  float* m = map.ptr<float>(0);
+  size_t overlap = 0;
+  for (size_t i = 0; i < count; i++)
+    {
+      const cv::Point2f& p = ir_pixels.ptr<cv::Point2f>(0)[i];
+      m[2 * i] = visible[i] ? p.x : -1000.0f;
+      m[2 * i + 1] = visible[i] ? p.y : -1000.0f;
+      overlap += visible[i] && p.x >= 0.0f && p.y >= 0.0f && p.x < ir_width_ - 1 && p.y < ir_height_ - 1;
+    }
+
+  cv::convertMaps(map, cv::Mat(), map1_, map2_, CV_16SC2);
+  maps_valid_ = true;
+
+  std::cout << "[REGISTRATION] Built a " << out_width_ << "x" << out_height_ << " map, the IR image covers "
+	    << (100.0 * overlap) / count << "% of it" << std::endl;
+
+  return 0;
+}
+
+void EoIrRegistration::blendRow( const uint8_t* eo, const uint8_t* thermal, uint8_t* out, int bytes )
+{
+  int i = 0;
+
+  // eo + (thermal - eo) * alpha / 128, sixteen bytes at a time
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha = _mm_set1_epi16((short)alpha_);
+  for (; i + 16 <= bytes; i += 16)
+    {
+      __m128i e = _mm_loadu_si128((const __m128i*)(eo + i));
+      __m128i t = _mm_loadu_si128((const __m128i*)(thermal + i));
+      __m128i e_lo = _mm_unpacklo_epi8(e, zero);
+      __m128i e_hi = _mm_unpackhi_epi8(e, zero);
+      __m128i t_lo = _mm_unpacklo_epi8(t, zero);
+      __m128i t_hi = _mm_unpackhi_epi8(t, zero);
+      __m128i lo = _mm_add_epi16(e_lo, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(t_lo, e_lo), alpha), 7));
+      __m128i hi = _mm_add_epi16(e_hi, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(t_hi, e_hi), alpha), 7));
+      _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+  const int16x8_t alpha = vdupq_n_s16((int16_t)alpha_);
+  for (; i + 16 <= bytes; i += 16)
+    {
+      uint8x16_t e = vld1q_u8(eo + i);
+      uint8x16_t t = vld1q_u8(thermal + i);
+      int16x8_t e_lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(e)));
+      int16x8_t e_hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(e)));
+      int16x8_t t_lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(t)));
+      int16x8_t t_hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(t)));
+      int16x8_t lo = vaddq_s16(e_lo, vshrq_n_s16(vmulq_s16(vsubq_s16(t_lo, e_lo), alpha), 7));
+      int16x8_t hi = vaddq_s16(e_hi, vshrq_n_s16(vmulq_s16(vsubq_s16(t_hi, e_hi), alpha), 7));
+      vst1q_u8(out + i, vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+    }
+#endif
+
+  for (; i < bytes; i++)
+    {
+      out[i] = (uint8_t)(eo[i] + (((thermal[i] - eo[i]) * alpha_) >> 7));
+    }
+}
+
+int EoIrRegistration::overlay( const cv::Mat& eo_bgr, const cv::Mat& ir, cv::Mat& output )
+{
+  if (eo_bgr.empty() || eo_bgr.type() != CV_8UC3)
+    {
+      std::cout << "[REGISTRATION] Expected a BGR8 EO frame" << std::endl;
+      return -1;
+    }
+  if (ir.cols != ir_width_ || ir.rows != ir_height_ || (ir.type() != CV_8UC1 && ir.type() != CV_16UC1))
+    {
+      std::cout << "[REGISTRATION] Expected a " << ir_width_ << "x" << ir_height_ << " 8 or 16 bit IR frame" << std::endl;
+      return -1;
+    }
+  if (!maps_valid_ && buildMaps() < 0)
+    {
+      return -1;
+    }
+
+  // the IR frame is small next to the EO frame, so Y16 gets its AGC up front
+  const cv::Mat* ir8 = &ir;
+  if (ir.type() == CV_16UC1)
+    {
+      double min, max;
+      cv::minMaxLoc(ir, &min, &max);
+      PixelPipeline< AgcStage<uint8_t> > agc(AgcStage<uint8_t>(min, max));
+      agc.run(ir, ir8_);
+      ir8 = &ir8_;
+    }
+
+  // nearest EO pixel for each output column, only redone when the EO size changes
+  if (eo_offsets_cols_ != eo_bgr.cols)
+    {
+      eo_offsets_.resize(out_width_);
+      for (int u = 0; u < out_width_; u++)
+	{
+	  eo_offsets_[u] = 3 * std::min((int)((u + 0.5) * eo_bgr.cols / out_width_), eo_bgr.cols - 1);
+	}
+      eo_offsets_cols_ = eo_bgr.cols;
+      eo_row_.resize(3 * out_width_);
+      thermal_row_.resize(3 * out_width_);
+    }
+
+  output.create(out_height_, out_width_, CV_8UC3);
+
+  const uint32_t* colors = palette_.getColors(false).data();
+  const uint8_t* ir_data = ir8->ptr<uint8_t>(0);
+  const size_t ir_step = ir8->step;
+  const unsigned x_limit = ir_width_ - 1;
+  const unsigned y_limit = ir_height_ - 1;
+  const bool direct = eo_bgr.cols == out_width_;
+
+  for (int v = 0; v < out_height_; v++)
+    {
+      const uint8_t* eo_src = eo_bgr.ptr<uint8_t>(std::min((int)((v + 0.5) * eo_bgr.rows / out_height_), eo_bgr.rows - 1));
+      const int16_t* xy = map1_.ptr<int16_t>(v);
+      const uint16_t* frac = map2_.ptr<uint16_t>(v);
+      uint8_t* eo = direct ? (uint8_t*)eo_src : eo_row_.data();
+      uint8_t* thermal = thermal_row_.data();
+
+      // gather the EO pixel and the bilinear IR sample through the palette,
+      // outside the IR image the thermal side is the EO pixel so the blend is a no-op
+      for (int u = 0; u < out_width_; u++)
+	{
+	  const uint8_t* e = eo_src + eo_offsets_[u];
+	  if (!direct)
+	    {
+	      eo[3 * u] = e[0];
+	      eo[3 * u + 1] = e[1];
+	      eo[3 * u + 2] = e[2];
+	    }
+
+	  int x = xy[2 * u];
+	  int y = xy[2 * u + 1];
+	  if ((unsigned)x < x_limit && (unsigned)y < y_limit)
+	    {
+	      const uint8_t* p = ir_data + y * ir_step + x;
+	      int fx = frac[u] & (cv::INTER_TAB_SIZE - 1);
+	      int fy = frac[u] >> cv::INTER_BITS;
+	      int top = p[0] * (cv::INTER_TAB_SIZE - fx) + p[1] * fx;
+	      int bottom = p[ir_step] * (cv::INTER_TAB_SIZE - fx) + p[ir_step + 1] * fx;
+	      uint32_t c = colors[(top * (cv::INTER_TAB_SIZE - fy) + bottom * fy + 512) >> 10];
+	      thermal[3 * u] = c & 0xff;
+	      thermal[3 * u + 1] = (c >> 8) & 0xff;
+	      thermal[3 * u + 2] = (c >> 16) & 0xff;
+	    }
+	  else
+	    {
+	      thermal[3 * u] = e[0];
+	      thermal[3 * u + 1] = e[1];
+	      thermal[3 * u + 2] = e[2];
+	    }
+	}
+
+      blendRow(eo, thermal, output.ptr<uint8_t>(v), 3 * out_width_);
+    }
+
+  return 0;
+}
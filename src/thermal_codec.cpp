@@ -0,0 +1,482 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Lossless Y16 codec, every block of 128 pixels picks whichever of
+ *        four predictors leaves the narrowest residuals and packs them at
+ *        that width, eight 16 bit lanes at a time
+ */
+
+#include "eeyore/thermal_codec.hpp"
+
+#include <cstring>
+
+// EEYORE_CODEC_SCALAR forces the portable lanes, which write the same stream
+#if defined(__SSE2__) && !defined(EEYORE_CODEC_SCALAR)
+#include <emmintrin.h>
+#define EEYORE_CODEC_SSE2 1
+#elif defined(__ARM_NEON) && !defined(EEYORE_CODEC_SCALAR)
+#include <arm_neon.h>
+#define EEYORE_CODEC_NEON 1
+#endif
+
+namespace
+{
+  const uint8_t CODEC_VERSION = 2;
+  const size_t HEADER_BYTES = 12;
+  const int BLOCK = 128;
+  const int LANES = 8;
+
+  // eight 16 bit lanes, the packed layout is the same whichever backend built it
+#if defined(EEYORE_CODEC_SSE2)
+  typedef __m128i u16x8;
+
+  inline u16x8 load8( const uint16_t* p ) { return _mm_loadu_si128((const __m128i*)p); }
+  inline void store8( uint16_t* p, u16x8 v ) { _mm_storeu_si128((__m128i*)p, v); }
+  inline u16x8 zero8() { return _mm_setzero_si128(); }
+  inline u16x8 sub8( u16x8 a, u16x8 b ) { return _mm_sub_epi16(a, b); }
+  inline u16x8 add8( u16x8 a, u16x8 b ) { return _mm_add_epi16(a, b); }
+  inline u16x8 or8( u16x8 a, u16x8 b ) { return _mm_or_si128(a, b); }
+  inline u16x8 shl8( u16x8 v, int n ) { return _mm_sll_epi16(v, _mm_cvtsi32_si128(n)); }
+  inline u16x8 shr8( u16x8 v, int n ) { return _mm_srl_epi16(v, _mm_cvtsi32_si128(n)); }
+  inline u16x8 zigzag8( u16x8 r ) { return _mm_xor_si128(_mm_slli_epi16(r, 1), _mm_srai_epi16(r, 15)); }
+#elif defined(EEYORE_CODEC_NEON)
+  typedef uint16x8_t u16x8;
+
+  inline u16x8 load8( const uint16_t* p ) { return vld1q_u16(p); }
+  inline void store8( uint16_t* p, u16x8 v ) { vst1q_u16(p, v); }
+  inline u16x8 zero8() { return vdupq_n_u16(0); }
+  inline u16x8 sub8( u16x8 a, u16x8 b ) { return vsubq_u16(a, b); }
+  inline u16x8 add8( u16x8 a, u16x8 b ) { return vaddq_u16(a, b); }
+  inline u16x8 or8( u16x8 a, u16x8 b ) { return vorrq_u16(a, b); }
+  inline u16x8 shl8( u16x8 v, int n ) { return vshlq_u16(v, vdupq_n_s16(n)); }
+  inline u16x8 shr8( u16x8 v, int n ) { return vshlq_u16(v, vdupq_n_s16(-n)); }
+  inline u16x8 zigzag8( u16x8 r )
+  {
+    return veorq_u16(vshlq_n_u16(r, 1), vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(r), 15)));
+  }
+#else
+  struct u16x8
+  {
+    uint16_t v[LANES];
+  };
+
+  inline u16x8 load8( const uint16_t* p ) { u16x8 r; memcpy(r.v, p, sizeof(r.v)); return r; }
+  inline void store8( uint16_t* p, u16x8 v ) { memcpy(p, v.v, sizeof(v.v)); }
+  inline u16x8 zero8() { u16x8 r; memset(r.v, 0, sizeof(r.v)); return r; }
+  inline u16x8 sub8( u16x8 a, u16x8 b ) { for (int i = 0; i < LANES; i++) a.v[i] -= b.v[i]; return a; }
+  inline u16x8 add8( u16x8 a, u16x8 b ) { for (int i = 0; i < LANES; i++) a.v[i] += b.v[i]; return a; }
+  inline u16x8 or8( u16x8 a, u16x8 b ) { for (int i = 0; i < LANES; i++) a.v[i] |= b.v[i]; return a; }
+  inline u16x8 shl8( u16x8 v, int n ) { for (int i = 0; i < LANES; i++) v.v[i] = n < 16 ? v.v[i] << n : 0; return v; }
+  inline u16x8 shr8( u16x8 v, int n ) { for (int i = 0; i < LANES; i++) v.v[i] = n < 16 ? v.v[i] >> n : 0; return v; }
+  inline u16x8 zigzag8( u16x8 r )
+  {
+    for (int i = 0; i < LANES; i++)
+      {
+	r.v[i] = (uint16_t)(r.v[i] << 1) ^ (uint16_t)((r.v[i] & 0x8000) ? 0xFFFF : 0);
+      }
+    return r;
+  }
+#endif
+
+  inline uint16_t reduceOr8( u16x8 v )
+  {
+    uint16_t lanes[LANES];
+    store8(lanes, v);
+    uint16_t r = 0;
+    for (int i = 0; i < LANES; i++)
+      {
+	r |= lanes[i];
+      }
+    return r;
+  }
+
+  inline int bitWidth( uint16_t v )
+  {
+    return v == 0 ? 0 : 32 - __builtin_clz(v);
+  }
+
+  // lane l of output word k holds bits 16k..16k+15 of the stream made by
+  // lane l of the 16 input vectors, so 128 values at w bits are w words per lane
+  template<int W>
+  void packBlock( const uint16_t* in, uint16_t* out )
+  {
+    u16x8 acc = zero8();
+    int bits = 0;
+
+    for (int j = 0; j < BLOCK / LANES; j++)
+      {
+	u16x8 v = load8(in + j * LANES);
+	acc = or8(acc, shl8(v, bits));
+	bits += W;
+	if (bits >= 16)
+	  {
+	    store8(out, acc);
+	    out += LANES;
+	    bits -= 16;
+	    acc = bits > 0 ? shr8(v, W - bits) : zero8();
+	  }
+      }
+  }
+
+  // one instance per width so the loop unrolls down to fixed shifts
+  void packBlock( const uint16_t* in, int width, uint16_t* out )
+  {
+    switch (width)
+      {
+      case 1: packBlock<1>(in, out); break;
+      case 2: packBlock<2>(in, out); break;
+      case 3: packBlock<3>(in, out); break;
+      case 4: packBlock<4>(in, out); break;
+      case 5: packBlock<5>(in, out); break;
+      case 6: packBlock<6>(in, out); break;
+      case 7: packBlock<7>(in, out); break;
+      case 8: packBlock<8>(in, out); break;
+      case 9: packBlock<9>(in, out); break;
+      case 10: packBlock<10>(in, out); break;
+      case 11: packBlock<11>(in, out); break;
+      case 12: packBlock<12>(in, out); break;
+      case 13: packBlock<13>(in, out); break;
+      case 14: packBlock<14>(in, out); break;
+      case 15: packBlock<15>(in, out); break;
+      default: packBlock<16>(in, out); break;
+      }
+  }
+
+  void unpackBlock( const uint16_t* in, int width, uint16_t* out )
+  {
+    uint16_t mask = (uint16_t)((1u << width) - 1);
+    u16x8 cur = load8(in);
+    in += LANES;
+    int bits = 0;
+
+    for (int j = 0; j < BLOCK / LANES; j++)
+      {
+	u16x8 v = shr8(cur, bits);
+	bits += width;
+	if (bits > 16)
+	  {
+	    cur = load8(in);
+	    in += LANES;
+	    bits -= 16;
+	    v = or8(v, shl8(cur, width - bits));
+	  }
+	else if (bits == 16 && j < BLOCK / LANES - 1)
+	  {
+	    cur = load8(in);
+	    in += LANES;
+	    bits = 0;
+	  }
+
+	uint16_t lanes[LANES];
+	store8(lanes, v);
+	for (int i = 0; i < LANES; i++)
+	  {
+	    out[j * LANES + i] = lanes[i] & mask;
+	  }
+      }
+  }
+
+  // rows are kept with one pixel of zero on the left and the last pixel
+  // repeated out to a whole block, so no predictor needs an edge case
+  int paddedWidth( int width )
+  {
+    return 1 + (width + BLOCK - 1) / BLOCK * BLOCK;
+  }
+
+  void padRow( const uint16_t* src, int width, uint16_t* dst, int padded )
+  {
+    dst[0] = 0;
+    memcpy(dst + 1, src, width * sizeof(uint16_t));
+    for (int i = width + 1; i < padded; i++)
+      {
+	dst[i] = src[width - 1];
+      }
+  }
+
+  void putU16( uint8_t* p, uint16_t v )
+  {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+  }
+
+  uint16_t getU16( const uint8_t* p )
+  {
+    return (uint16_t)(p[0] | (p[1] << 8));
+  }
+}
+
+ThermalEncoder::ThermalEncoder()
+{
+  width_ = 0;
+  height_ = 0;
+  keyframe_interval_ = 60;
+  since_keyframe_ = 0;
+  frame_counter_ = 0;
+}
+
+void ThermalEncoder::setKeyframeInterval( int frames )
+{
+  keyframe_interval_ = frames;
+}
+
+int ThermalEncoder::getKeyframeInterval()
+{
+  return keyframe_interval_;
+}
+
+void ThermalEncoder::reset()
+{
+  previous_.clear();
+  since_keyframe_ = 0;
+}
+
+size_t ThermalEncoder::maxEncodedSize( int width, int height )
+{
+  size_t blocks = (size_t)height * ((width + BLOCK - 1) / BLOCK);
+  return HEADER_BYTES + blocks * (1 + BLOCK * sizeof(uint16_t));
+}
+
+int ThermalEncoder::encode( const cv::Mat& frame_16, std::vector<uint8_t>& out )
+{
+  // only ever grows, so a steady stream never reallocates or clears it
+  size_t needed = maxEncodedSize(frame_16.cols, frame_16.rows);
+  if (out.size() < needed)
+    {
+      out.resize(needed);
+    }
+  return encode(frame_16, out.data(), out.size());
+}
+
+int ThermalEncoder::encode( const cv::Mat& frame_16, uint8_t* out, size_t capacity )
+{
+  if (frame_16.empty() || frame_16.type() != CV_16UC1 || frame_16.cols > 0xFFFF || frame_16.rows > 0xFFFF)
+    {
+      std::cout << "[CODEC] Expected a CV_16UC1 frame" << std::endl;
+      return -1;
+    }
+  if (capacity < maxEncodedSize(frame_16.cols, frame_16.rows))
+    {
+      std::cout << "[CODEC] Output buffer too small" << std::endl;
+      return -1;
+    }
+
+  int padded = paddedWidth(frame_16.cols);
+  bool intra = previous_.empty() || width_ != frame_16.cols || height_ != frame_16.rows || since_keyframe_ >= keyframe_interval_;
+
+  if (width_ != frame_16.cols || height_ != frame_16.rows || previous_.empty())
+    {
+      width_ = frame_16.cols;
+      height_ = frame_16.rows;
+      previous_.assign((size_t)padded * height_, 0);
+      current_row_.assign(padded, 0);
+      zero_row_.assign(padded, 0);
+      residuals_.assign(4 * BLOCK, 0);
+    }
+  since_keyframe_ = intra ? 1 : since_keyframe_ + 1;
+
+  memcpy(out, "EYTC", 4);
+  out[4] = CODEC_VERSION;
+  out[5] = intra ? 0 : 1;
+  putU16(out + 6, (uint16_t)width_);
+  putU16(out + 8, (uint16_t)height_);
+  putU16(out + 10, frame_counter_++);
+  uint8_t* p = out + HEADER_BYTES;
+
+  uint16_t* residuals[4] = {&residuals_[0], &residuals_[BLOCK], &residuals_[2 * BLOCK], &residuals_[3 * BLOCK]};
+  int predictors = intra ? 2 : 4;
+
+  for (int r = 0; r < height_; r++)
+    {
+      uint16_t* cur = current_row_.data();
+      uint16_t* prev = &previous_[(size_t)r * padded];
+      // rows above this one in previous_ already hold this frame
+      const uint16_t* up = r > 0 ? prev - padded : zero_row_.data();
+      padRow(frame_16.ptr<uint16_t>(r), width_, cur, padded);
+
+      for (int b = 0; b + 1 < padded; b += BLOCK)
+	{
+	  u16x8 any_left = zero8();
+	  u16x8 any_up = zero8();
+	  u16x8 any_temporal = zero8();
+	  u16x8 any_temporal_left = zero8();
+
+	  // residuals for every predictor at once, the widest bit in each
+	  // OR gives the width that block would pack at
+	  for (int j = 0; j < BLOCK; j += LANES)
+	    {
+	      const int i = b + 1 + j;
+	      u16x8 x = load8(cur + i);
+	      u16x8 left = load8(cur + i - 1);
+	      u16x8 z = zigzag8(sub8(x, left));
+	      any_left = or8(any_left, z);
+	      store8(residuals[PREDICT_LEFT] + j, z);
+
+	      z = zigzag8(sub8(x, load8(&up[i])));
+	      any_up = or8(any_up, z);
+	      store8(residuals[PREDICT_UP] + j, z);
+
+	      // on a keyframe previous_ still holds something, the widths are just never looked at
+	      u16x8 last = load8(prev + i);
+	      z = zigzag8(sub8(x, last));
+	      any_temporal = or8(any_temporal, z);
+	      store8(residuals[PREDICT_TEMPORAL] + j, z);
+
+	      z = zigzag8(sub8(sub8(x, left), sub8(last, load8(prev + i - 1))));
+	      any_temporal_left = or8(any_temporal_left, z);
+	      store8(residuals[PREDICT_TEMPORAL_LEFT] + j, z);
+	    }
+
+	  int widths[4] = {bitWidth(reduceOr8(any_left)), bitWidth(reduceOr8(any_up)),
+			   bitWidth(reduceOr8(any_temporal)), bitWidth(reduceOr8(any_temporal_left))};
+	  int best = 0;
+	  for (int m = 1; m < predictors; m++)
+	    {
+	      if (widths[m] < widths[best])
+		{
+		  best = m;
+		}
+	    }
+	  int best_width = widths[best];
+
+	  *p++ = (uint8_t)(best << 5 | best_width);
+	  if (best_width > 0)
+	    {
+	      uint16_t packed[BLOCK];
+	      packBlock(residuals[best], best_width, packed);
+	      memcpy(p, packed, best_width * LANES * sizeof(uint16_t));
+	      p += best_width * LANES * sizeof(uint16_t);
+	    }
+	}
+
+      memcpy(prev, cur, padded * sizeof(uint16_t));
+    }
+
+  return (int)(p - out);
+}
+
+ThermalDecoder::ThermalDecoder()
+{
+  width_ = 0;
+  height_ = 0;
+  last_counter_ = 0;
+}
+
+void ThermalDecoder::reset()
+{
+  previous_.clear();
+}
+
+int ThermalDecoder::decode( const uint8_t* data, size_t bytes, cv::Mat& frame_16 )
+{
+  if (bytes < HEADER_BYTES || memcmp(data, "EYTC", 4) != 0 || data[4] != CODEC_VERSION)
+    {
+      std::cout << "[CODEC] Not a thermal codec frame" << std::endl;
+      return -1;
+    }
+
+  bool intra = data[5] == 0;
+  int width = getU16(data + 6);
+  int height = getU16(data + 8);
+  uint16_t counter = getU16(data + 10);
+  int padded = paddedWidth(width);
+
+  if (!intra && (previous_.empty() || width != width_ || height != height_))
+    {
+      std::cout << "[CODEC] Inter frame without its reference, waiting for a keyframe" << std::endl;
+      return -1;
+    }
+
+  // an inter frame is only good on top of the frame right before it, after
+  // a lost frame the reference is wrong until the next keyframe
+  if (!intra && counter != (uint16_t)(last_counter_ + 1))
+    {
+      std::cout << "[CODEC] Expected frame " << (uint16_t)(last_counter_ + 1) << " but got " << counter
+		<< ", waiting for a keyframe" << std::endl;
+      previous_.clear();
+      return -1;
+    }
+
+  if (width != width_ || height != height_ || previous_.empty())
+    {
+      width_ = width;
+      height_ = height;
+      previous_.assign((size_t)padded * height_, 0);
+      current_row_.assign(padded, 0);
+      zero_row_.assign(padded, 0);
+      residuals_.assign(BLOCK, 0);
+    }
+
+  frame_16.create(height_, width_, CV_16UC1);
+
+  const uint8_t* p = data + HEADER_BYTES;
+  const uint8_t* end = data + bytes;
+
+  for (int r = 0; r < height_; r++)
+    {
+      uint16_t* cur = current_row_.data();
+      uint16_t* prev = &previous_[(size_t)r * padded];
+      const uint16_t* up = r > 0 ? prev - padded : zero_row_.data();
+
+      for (int b = 0; b + 1 < padded; b += BLOCK)
+	{
+	  if (p >= end)
+	    {
+	      std::cout << "[CODEC] Frame is truncated" << std::endl;
+	      previous_.clear();
+	      return -1;
+	    }
+
+	  int predictor = *p >> 5;
+	  int width_bits = *p & 0x1F;
+	  p++;
+
+	  size_t payload = width_bits * LANES * sizeof(uint16_t);
+	  if (width_bits > 16 || (intra && predictor >= PREDICT_TEMPORAL) || (size_t)(end - p) < payload)
+	    {
+	      std::cout << "[CODEC] Frame is corrupt" << std::endl;
+	      previous_.clear();
+	      return -1;
+	    }
+
+	  uint16_t* z = residuals_.data();
+	  if (width_bits > 0)
+	    {
+	      uint16_t packed[BLOCK];
+	      memcpy(packed, p, payload);
+	      unpackBlock(packed, width_bits, z);
+	      p += payload;
+	    }
+	  else
+	    {
+	      memset(z, 0, BLOCK * sizeof(uint16_t));
+	    }
+
+	  uint16_t* x = cur + b + 1;
+	  for (int j = 0; j < BLOCK; j++)
+	    {
+	      uint16_t residual = (uint16_t)((z[j] >> 1) ^ (0 - (z[j] & 1)));
+	      const int i = b + 1 + j;
+	      switch (predictor)
+		{
+		case PREDICT_LEFT:
+		  x[j] = cur[i - 1] + residual;
+		  break;
+		case PREDICT_UP:
+		  x[j] = up[i] + residual;
+		  break;
+		case PREDICT_TEMPORAL:
+		  x[j] = prev[i] + residual;
+		  break;
+		default:
+		  x[j] = prev[i] + (uint16_t)(cur[i - 1] - prev[i - 1]) + residual;
+		  break;
+		}
+	    }
+	}
+
+      memcpy(frame_16.ptr<uint16_t>(r), cur + 1, width_ * sizeof(uint16_t));
+      memcpy(prev, cur, padded * sizeof(uint16_t));
+    }
+  last_counter_ = counter;
+
+  return 0;
+}
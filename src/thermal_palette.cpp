@@ -0,0 +1,294 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Fused AGC and palette mapping for thermal display output
+ */
+
+#include "eeyore/thermal_palette.hpp"
+
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define EEYORE_PALETTE_SIMD 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define EEYORE_PALETTE_SIMD 1
+#endif
+
+#ifdef EEYORE_PALETTE_SIMD
+// the range tracking and the clamp into the table run 8 pixels at a time,
+// the lookups themselves stay scalar since neither SSE2 nor NEON can gather
+namespace
+{
+#if defined(__SSE2__)
+  // SSE2 only has signed 16 bit min/max, flipping the top bit puts unsigned
+  // values in the same order
+  struct RangeLanes
+  {
+    __m128i bias, lo, hi, min, max;
+  };
+
+  inline RangeLanes rangeLanes( uint16_t lo, uint16_t hi )
+  {
+    RangeLanes r;
+    r.bias = _mm_set1_epi16((short)0x8000);
+    r.lo = _mm_set1_epi16((short)(lo ^ 0x8000));
+    r.hi = _mm_set1_epi16((short)(hi ^ 0x8000));
+    r.min = _mm_set1_epi16(0x7FFF);
+    r.max = _mm_set1_epi16((short)0x8000);
+    return r;
+  }
+
+  inline void clamp8( const uint16_t* in, RangeLanes& r, uint16_t* index )
+  {
+    __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), r.bias);
+    r.min = _mm_min_epi16(r.min, v);
+    r.max = _mm_max_epi16(r.max, v);
+    _mm_storeu_si128((__m128i*)index, _mm_xor_si128(_mm_min_epi16(_mm_max_epi16(v, r.lo), r.hi), r.bias));
+  }
+
+  inline void reduceRange( const RangeLanes& r, uint16_t& min, uint16_t& max )
+  {
+    uint16_t lanes_min[8], lanes_max[8];
+    _mm_storeu_si128((__m128i*)lanes_min, _mm_xor_si128(r.min, r.bias));
+    _mm_storeu_si128((__m128i*)lanes_max, _mm_xor_si128(r.max, r.bias));
+    for (int k = 0; k < 8; k++)
+      {
+	min = lanes_min[k] < min ? lanes_min[k] : min;
+	max = lanes_max[k] > max ? lanes_max[k] : max;
+      }
+  }
+#elif defined(__ARM_NEON)
+  struct RangeLanes
+  {
+    uint16x8_t lo, hi, min, max;
+  };
+
+  inline RangeLanes rangeLanes( uint16_t lo, uint16_t hi )
+  {
+    RangeLanes r;
+    r.lo = vdupq_n_u16(lo);
+    r.hi = vdupq_n_u16(hi);
+    r.min = vdupq_n_u16(0xFFFF);
+    r.max = vdupq_n_u16(0);
+    return r;
+  }
+
+  inline void clamp8( const uint16_t* in, RangeLanes& r, uint16_t* index )
+  {
+    uint16x8_t v = vld1q_u16(in);
+    r.min = vminq_u16(r.min, v);
+    r.max = vmaxq_u16(r.max, v);
+    vst1q_u16(index, vminq_u16(vmaxq_u16(v, r.lo), r.hi));
+  }
+
+  inline void reduceRange( const RangeLanes& r, uint16_t& min, uint16_t& max )
+  {
+    uint16_t lanes_min[8], lanes_max[8];
+    vst1q_u16(lanes_min, r.min);
+    vst1q_u16(lanes_max, r.max);
+    for (int k = 0; k < 8; k++)
+      {
+	min = lanes_min[k] < min ? lanes_min[k] : min;
+	max = lanes_max[k] > max ? lanes_max[k] : max;
+      }
+  }
+#endif
+}
+#endif
+
+ThermalPalette::ThermalPalette()
+{
+  lut_.resize(65536);
+  lut_min_ = 0;
+  lut_max_ = 0;
+  lut_rgba_ = false;
+  lut_valid_ = false;
+  setPalette( cv::COLORMAP_INFERNO );
+}
+
+void ThermalPalette::setPalette( int colormap )
+{
+  colormap_ = colormap;
+
+  // let OpenCV render the palette once, everything after is table lookups
+  cv::Mat ramp(1, 256, CV_8UC1);
+  for (int i = 0; i < 256; i++)
+    {
+      ramp.at<uint8_t>(0, i) = i;
+    }
+
+  cv::Mat colors;
+  cv::applyColorMap(ramp, colors, colormap);
+
+  colors_bgra_.resize(256);
+  colors_rgba_.resize(256);
+  for (int i = 0; i < 256; i++)
+    {
+      const cv::Vec3b& c = colors.at<cv::Vec3b>(0, i);
+      uint8_t bgra[4] = { c[0], c[1], c[2], 255 };
+      uint8_t rgba[4] = { c[2], c[1], c[0], 255 };
+      memcpy(&colors_bgra_[i], bgra, 4);
+      memcpy(&colors_rgba_[i], rgba, 4);
+    }
+
+  lut_valid_ = false;
+}
+
+int ThermalPalette::getPalette()
+{
+  return colormap_;
+}
+
+int ThermalPalette::getRangeMin()
+{
+  return lut_min_;
+}
+
+int ThermalPalette::getRangeMax()
+{
+  return lut_max_;
+}
+
+const std::vector<uint32_t>& ThermalPalette::getColors( bool rgba )
+{
+  return rgba ? colors_rgba_ : colors_bgra_;
+}
+
+void ThermalPalette::rebuildLut( int min, int max, bool rgba )
+{
+  const std::vector<uint32_t>& colors = rgba ? colors_rgba_ : colors_bgra_;
+  int span = max > min ? max - min : 1;
+
+  // only the range itself is filled, lookups clamp into it first
+  for (int v = min; v <= max; v++)
+    {
+      lut_[v] = colors[(255 * (v - min)) / span];
+    }
+
+  lut_min_ = min;
+  lut_max_ = max;
+  lut_rgba_ = rgba;
+  lut_valid_ = true;
+}
+
+void ThermalPalette::apply16( const cv::Mat& input_16, cv::Mat& output, bool rgba )
+{
+  int rows = input_16.rows;
+  int cols = input_16.cols;
+
+  if (!lut_valid_ || lut_rgba_ != rgba)
+    {
+      double min, max;
+      cv::minMaxLoc(input_16, &min, &max);
+      rebuildLut((int)min, (int)max, rgba);
+    }
+
+  output.create(rows, cols, rgba ? CV_8UC4 : CV_8UC3);
+
+  // map with the current table and collect this frame's range on the same
+  // pass, the table follows the scene one frame behind
+  const uint32_t* lut = &lut_[0];
+  const uint16_t lo = lut_min_;
+  const uint16_t hi = lut_max_;
+  uint16_t min = 65535;
+  uint16_t max = 0;
+
+#ifdef EEYORE_PALETTE_SIMD
+  RangeLanes range = rangeLanes(lo, hi);
+#endif
+
+  for (int i = 0; i < rows; i++)
+    {
+      const uint16_t* in = input_16.ptr<uint16_t>(i);
+      uint8_t* out = output.ptr<uint8_t>(i);
+      int bytes = rgba ? 4 : 3;
+      int j = 0;
+
+#ifdef EEYORE_PALETTE_SIMD
+      for (; j + 8 <= cols; j += 8)
+	{
+	  uint16_t index[8];
+	  clamp8(in + j, range, index);
+
+	  // BGR pixels go out as 4 byte stores too, each one's spare byte is
+	  // overwritten by the next pixel, only the last of the row can't do that
+	  int whole = rgba || j + 8 < cols ? 8 : 7;
+	  for (int k = 0; k < whole; k++)
+	    {
+	      memcpy(out + bytes * (j + k), &lut[index[k]], 4);
+	    }
+	  if (whole < 8)
+	    {
+	      memcpy(out + bytes * (j + 7), &lut[index[7]], 3);
+	    }
+	}
+#endif
+
+      for (; j < cols; j++)
+	{
+	  uint16_t v = in[j];
+	  min = v < min ? v : min;
+	  max = v > max ? v : max;
+	  const uint32_t* c = &lut[v < lo ? lo : (v > hi ? hi : v)];
+	  if (rgba)
+	    {
+	      memcpy(out + 4 * j, c, 4);
+	    }
+	  else
+	    {
+	      memcpy(out + 3 * j, c, 3);
+	    }
+	}
+    }
+
+#ifdef EEYORE_PALETTE_SIMD
+  reduceRange(range, min, max);
+#endif
+
+  // scene noise moves the extremes a few counts every frame, only rebuild
+  // once an end has drifted past a fraction of the range so a static scene
+  // keeps its table
+  int tolerance = (lut_max_ - lut_min_) / 64;
+  tolerance = tolerance < 4 ? 4 : tolerance;
+  if (abs(min - lut_min_) > tolerance || abs(max - lut_max_) > tolerance)
+    {
+      rebuildLut(min, max, rgba);
+    }
+}
+
+void ThermalPalette::apply8( const cv::Mat& input_8, cv::Mat& output, bool rgba )
+{
+  int rows = input_8.rows;
+  int cols = input_8.cols;
+  const std::vector<uint32_t>& colors = rgba ? colors_rgba_ : colors_bgra_;
+
+  // the camera already did the AGC, so this is just the palette
+  output.create(rows, cols, rgba ? CV_8UC4 : CV_8UC3);
+
+  for (int i = 0; i < rows; i++)
+    {
+      const uint8_t* in = input_8.ptr<uint8_t>(i);
+
+      if (rgba)
+	{
+	  uint32_t* out = output.ptr<uint32_t>(i);
+	  for (int j = 0; j < cols; j++)
+	    {
+	      out[j] = colors[in[j]];
+	    }
+	}
+      else
+	{
+	  uint8_t* out = output.ptr<uint8_t>(i);
+	  for (int j = 0; j < cols; j++)
+	    {
+	      uint32_t c = colors[in[j]];
+	      out[3 * j] = c & 0xff;
+	      out[3 * j + 1] = (c >> 8) & 0xff;
+	      out[3 * j + 2] = (c >> 16) & 0xff;
+	    }
+	}
+    }
+}
@@ -0,0 +1,73 @@
+/* Author: Jason Hughes
+ * Date: October 2026
+ * About: Checks for the redundant frame filter, a change confined to one
+ *        block of the signature grid has to make a keyframe
+ */
+
+#include "eeyore/frame_filter.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  const int WIDTH = 640;
+  const int HEIGHT = 480;
+
+  // flat gray, with an optional square of another level at x, y
+  cv::Mat makeFrame( int level, int x = 0, int y = 0, int size = 0, int spot = 0 )
+  {
+    cv::Mat frame(HEIGHT, WIDTH, CV_8UC1, cv::Scalar(level));
+    for (int r = y; r < y + size; r++)
+      {
+	uint8_t* row = frame.ptr<uint8_t>(r);
+	for (int c = x; c < x + size; c++)
+	  {
+	    row[c] = spot;
+	  }
+      }
+    return frame;
+  }
+}
+
+TEST(FrameFilter, UnchangedFrameIsRedundant)
+{
+  FrameFilter filter;
+  filter.setMaxInterval(0);
+
+  EXPECT_TRUE(filter.update(makeFrame(100)).keyframe);
+  FilterResult result = filter.update(makeFrame(100));
+  EXPECT_FALSE(result.keyframe);
+  EXPECT_EQ(result.difference, 0.0);
+}
+
+TEST(FrameFilter, SingleBlockChangeIsKeyframe)
+{
+  FrameFilter filter;
+  filter.setMaxInterval(0);
+
+  // the default 16 x 12 grid makes 40 x 40 blocks, the spot fills one of them
+  EXPECT_TRUE(filter.update(makeFrame(100)).keyframe);
+  FilterResult result = filter.update(makeFrame(100, 280, 200, 40, 200));
+  EXPECT_TRUE(result.keyframe);
+  EXPECT_NEAR(result.difference, 100.0 / 255.0, 1e-6);
+
+  // the spot is the new reference, it staying put is redundant again
+  EXPECT_FALSE(filter.update(makeFrame(100, 280, 200, 40, 200)).keyframe);
+}
+
+TEST(FrameFilter, ForcedKeyframeInterval)
+{
+  FrameFilter filter;
+  filter.setMaxInterval(3);
+
+  EXPECT_TRUE(filter.update(makeFrame(100)).keyframe);
+  EXPECT_FALSE(filter.update(makeFrame(100)).keyframe);
+  EXPECT_FALSE(filter.update(makeFrame(100)).keyframe);
+  EXPECT_TRUE(filter.update(makeFrame(100)).keyframe);
+}
+
+int main( int argc, char** argv )
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}